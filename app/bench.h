@@ -0,0 +1,43 @@
+/*
+ * kernel micro-benchmark support.
+ *
+ * results are printed one per line, in a fixed format:
+ *
+ * bench;<name>;<param>;<ops>;<total>;<per op>
+ *
+ * times are in _readcycles() units (CPU cycles on the Qemu targets, run
+ * them with -icount for reproducible numbers) and include the loop. HALs
+ * without a cycle counter use _readcounter() instead (timer cycles on
+ * HF-RISC, nanoseconds on the host). a run starts with 'bench;begin;<arch>' and the cost of
+ * a counter read ('bench;counter;...'), and ends with 'bench;end', so a
+ * script can grep the lines and compare them between releases.
+ */
+
+#define BENCH_PREFIX		"\nbench;"
+
+#ifndef _readcycles
+#define _readcycles()		_readcounter()
+#endif
+
+extern struct kcb_s *kcb_p;
+
+static void bench_report(char *name, int32_t param, uint32_t ops, uint32_t total)
+{
+	printf(BENCH_PREFIX "%s;%ld;%ld;%ld;%ld", name, (long)param, (long)ops,
+		(long)total, (long)(ops ? total / ops : 0));
+}
+
+static void bench_begin(void)
+{
+	uint32_t t0, t1;
+	
+	t0 = _readcycles();
+	t1 = _readcycles();
+	printf(BENCH_PREFIX "begin;%s", __ARCH__);
+	bench_report("counter", 0, 1, t1 - t0);
+}
+
+static void bench_end(void)
+{
+	printf(BENCH_PREFIX "end\n");
+}
@@ -0,0 +1,68 @@
+#include <ucx.h>
+#include <fixed.h>
+#include "bench.h"
+
+#define BENCH_ITER	1000
+
+/* fixed point math cost (include/fixed.h) */
+
+volatile fixed_t sink;
+
+void task0(void)
+{
+	uint32_t t0, t1;
+	int32_t i;
+	fixed_t x = fix_val(0.5), y = fix_val(1.25);
+
+	ucx_task_init();
+
+	bench_begin();
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_mul(x + i, y);
+	t1 = _readcycles();
+	bench_report("fix_mul", FIX_FBITS, BENCH_ITER, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_div(x + i, y);
+	t1 = _readcycles();
+	bench_report("fix_div", FIX_FBITS, BENCH_ITER, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_sqrt(y + i);
+	t1 = _readcycles();
+	bench_report("fix_sqrt", FIX_FBITS, BENCH_ITER, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_sin(x + i);
+	t1 = _readcycles();
+	bench_report("fix_sin", FIX_FBITS, BENCH_ITER, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_exp(x + i);
+	t1 = _readcycles();
+	bench_report("fix_exp", FIX_FBITS, BENCH_ITER, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		sink = fix_ln(y + i);
+	t1 = _readcycles();
+	bench_report("fix_ln", FIX_FBITS, BENCH_ITER, t1 - t0);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
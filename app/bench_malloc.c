@@ -0,0 +1,71 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_ITER	1000
+#define BLOCKS		64
+#define MIN_SIZE	8
+#define MAX_SIZE	256
+
+/*
+ * ucx_malloc() / ucx_free() cost. the heap is first fragmented with blocks
+ * of random sizes, half of them freed, then random blocks are replaced.
+ */
+
+void *block[BLOCKS];
+
+static uint32_t size(void)
+{
+	return MIN_SIZE + (random() % (MAX_SIZE - MIN_SIZE));
+}
+
+void task0(void)
+{
+	uint32_t t0, t1, tm = 0, tf = 0;
+	int32_t i, k, nf = 0;
+
+	ucx_task_init();
+
+	bench_begin();
+	srand(1234);
+	
+	for (i = 0; i < BLOCKS; i++)
+		block[i] = malloc(size());
+	for (i = 0; i < BLOCKS; i += 2) {
+		free(block[i]);
+		block[i] = 0;
+	}
+	
+	for (i = 0; i < BENCH_ITER; i++) {
+		k = random() % BLOCKS;
+		if (block[k]) {
+			t0 = _readcycles();
+			free(block[k]);
+			t1 = _readcycles();
+			tf += t1 - t0;
+			nf++;
+		}
+		t0 = _readcycles();
+		block[k] = malloc(size());
+		t1 = _readcycles();
+		tm += t1 - t0;
+	}
+	
+	bench_report("malloc", BLOCKS, BENCH_ITER, tm);
+	bench_report("free", BLOCKS, nf, tf);
+
+	for (i = 0; i < BLOCKS; i++)
+		if (block[i])
+			free(block[i]);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
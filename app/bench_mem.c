@@ -0,0 +1,101 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_SIZE	1024
+#define BENCH_ITER	64
+
+/* memory and string function cost, per call on a BENCH_SIZE buffer:
+ * aligned buffers and buffers with different alignments (source words
+ * shifted and merged). strings are BENCH_SIZE - 1 characters long. */
+
+static char buf0[BENCH_SIZE + 8], buf1[BENCH_SIZE + 8];
+static char line[] = "GET /index.html HTTP/1.1\r\nHost: ucx\r\n";
+
+void task0(void)
+{
+	uint32_t t0, t1;
+	int32_t i;
+
+	ucx_task_init();
+
+	bench_begin();
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memcpy(buf0, buf1, BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memcpy", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memcpy(buf0, buf1 + 1, BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memcpy_unaligned", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memmove(buf0 + 8, buf0, BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memmove", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memset(buf0, i, BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memset", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	memcpy(buf1, buf0, BENCH_SIZE);
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memcmp(buf0, buf1, BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memcmp", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	memset(buf0, 'a', BENCH_SIZE - 1);
+	buf0[BENCH_SIZE - 1] = '\0';
+	memcpy(buf1, buf0, BENCH_SIZE);
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		strlen(buf0);
+	t1 = _readcycles();
+	bench_report("strlen", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		strchr(buf0, 'b');
+	t1 = _readcycles();
+	bench_report("strchr", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		strcmp(buf0, buf1);
+	t1 = _readcycles();
+	bench_report("strcmp", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		memchr(buf0, 'b', BENCH_SIZE);
+	t1 = _readcycles();
+	bench_report("memchr", BENCH_SIZE, BENCH_ITER, t1 - t0);
+
+	/* a protocol line, searched for a missing field name */
+	for (i = 0; i < BENCH_SIZE - 1; i++)
+		buf0[i] = line[i % (sizeof(line) - 1)];
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		strstr(buf0, "Content-Length:");
+	t1 = _readcycles();
+	bench_report("strstr", BENCH_SIZE, BENCH_ITER, t1 - t0);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
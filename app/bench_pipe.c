@@ -0,0 +1,47 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_BYTES	8192
+#define PIPE_SIZE	128
+
+/* ucx_pipe_write() / ucx_pipe_read() throughput, for several chunk sizes */
+
+struct pipe_s *pipe0;
+
+void task0(void)
+{
+	char buf[PIPE_SIZE];
+	uint32_t t0, t1;
+	int32_t i, n, chunk[] = {1, 4, 16, 64};
+
+	ucx_task_init();
+
+	bench_begin();
+	memset(buf, 0x55, sizeof(buf));
+	
+	for (i = 0; i < sizeof(chunk) / sizeof(int32_t); i++) {
+		t0 = _readcycles();
+		for (n = 0; n < BENCH_BYTES; n += chunk[i]) {
+			ucx_pipe_write(pipe0, buf, chunk[i]);
+			ucx_pipe_read(pipe0, buf, chunk[i]);
+		}
+		t1 = _readcycles();
+		
+		/* per byte, written and read */
+		bench_report("pipe", chunk[i], BENCH_BYTES, t1 - t0);
+	}
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+
+	pipe0 = ucx_pipe_create(PIPE_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,44 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_ITER	100
+
+/* formatted output cost, per character: sprintf() and printf() to the console */
+
+void task0(void)
+{
+	char buf[64];
+	uint32_t t0, t1;
+	int32_t i, n = 0;
+
+	ucx_task_init();
+
+	bench_begin();
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++) {
+		sprintf(buf, "\n%s %d %x %c", "format", i, 0x1234abcd, '!');
+		n += strlen(buf);
+	}
+	t1 = _readcycles();
+	bench_report("sprintf", BENCH_ITER, n, t1 - t0);
+
+	/* same output, same number of characters */
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		printf("\n%s %d %x %c", "format", i, 0x1234abcd, '!');
+	t1 = _readcycles();
+	bench_report("printf", BENCH_ITER, n, t1 - t0);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
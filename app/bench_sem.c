@@ -0,0 +1,65 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_ITER	32
+
+/* ucx_wait() / ucx_signal() ping-pong between two tasks */
+
+struct sem_s *ping, *pong, *lock;
+
+void task0(void)
+{
+	uint32_t t0, t1;
+	int32_t i;
+
+	ucx_task_init();
+
+	bench_begin();
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++) {
+		ucx_signal(ping);
+		ucx_wait(pong);
+	}
+	t1 = _readcycles();
+	
+	/* a round trip is two handoffs */
+	bench_report("sem", 2, BENCH_ITER * 2, t1 - t0);
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++) {
+		ucx_wait(lock);
+		ucx_signal(lock);
+	}
+	t1 = _readcycles();
+	
+	/* uncontended, the semaphore never blocks */
+	bench_report("sem", 1, BENCH_ITER * 2, t1 - t0);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+void task1(void)
+{
+	ucx_task_init();
+
+	for (;;) {
+		ucx_wait(ping);
+		ucx_signal(pong);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	ping = ucx_semcreate(0);
+	pong = ucx_semcreate(0);
+	lock = ucx_semcreate(1);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,99 @@
+#include <ucx.h>
+#include "bench.h"
+
+/* number of tasks, including the measuring task (the idle task is not counted) */
+#ifndef BENCH_TASKS
+#define BENCH_TASKS	4
+#endif
+
+#define BENCH_TICKS	50
+#define BENCH_CHUNK	1000
+#define BENCH_RUNS	3
+
+/*
+ * tick overhead as a function of the number of tasks. the same work loop is
+ * timed with interrupts disabled and with the tick running, the difference
+ * is the time spent in krnl_dispatcher(). the other tasks have a lower
+ * priority, so the measuring task is never switched out. differences and
+ * ticks are summed over the same runs, so the overhead per tick is not
+ * skewed by comparing the best run of each kind.
+ */
+
+static volatile uint32_t sink;
+
+static void work(uint32_t n)
+{
+	uint32_t i;
+	
+	for (i = 0; i < n; i++)
+		sink++;
+}
+
+void task0(void)
+{
+	uint32_t t0, t1, s0, idle, ticks = 0, n = 0;
+	int32_t i, status, delta = 0;
+
+	ucx_task_init();
+
+	bench_begin();
+
+	/* size the work loop to last about BENCH_TICKS ticks */
+	s0 = kcb_p->ctx_switches;
+	while (s0 == kcb_p->ctx_switches);
+	s0 = kcb_p->ctx_switches;
+	while (kcb_p->ctx_switches - s0 < BENCH_TICKS) {
+		work(BENCH_CHUNK);
+		n += BENCH_CHUNK;
+	}
+	
+	/* a few runs, to average out noise */
+	for (i = 0; i < BENCH_RUNS; i++) {
+		status = _di();
+		t0 = _readcycles();
+		work(n);
+		t1 = _readcycles();
+		_ei(status);
+		idle = t1 - t0;
+		
+		s0 = kcb_p->ctx_switches;
+		t0 = _readcycles();
+		work(n);
+		t1 = _readcycles();
+		ticks += kcb_p->ctx_switches - s0;
+		delta += (int32_t)(t1 - t0 - idle);
+	}
+	
+	/* an overhead below the counter resolution (or noise larger than
+	 * it) is reported as such, not as a cost of 0 */
+	if (delta > 0)
+		bench_report("tick", BENCH_TASKS, ticks, delta);
+	else
+		printf(BENCH_PREFIX "tick;%ld;%ld;%d;unmeasurable", (long)BENCH_TASKS,
+			(long)ticks, (int)delta);
+	bench_end();
+
+	for (;;)
+		ucx_task_delay(100);
+}
+
+void task1(void)
+{
+	ucx_task_init();
+
+	for (;;);
+}
+
+int32_t app_main(void)
+{
+	int32_t i;
+	
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	for (i = 1; i < BENCH_TASKS; i++) {
+		ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+		ucx_task_priority(i, TASK_LOW_PRIO);
+	}
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,46 @@
+#include <ucx.h>
+#include "bench.h"
+
+#define BENCH_ITER	1000
+
+/* cooperative context switch cost, ucx_task_yield() between two tasks */
+
+void task0(void)
+{
+	uint32_t t0, t1;
+	int32_t i;
+
+	ucx_task_init();
+
+	bench_begin();
+	ucx_task_yield();
+	
+	t0 = _readcycles();
+	for (i = 0; i < BENCH_ITER; i++)
+		ucx_task_yield();
+	t1 = _readcycles();
+	
+	/* each yield switches to task1 and back */
+	bench_report("yield", 2, BENCH_ITER * 2, t1 - t0);
+	bench_end();
+
+	for (;;)
+		ucx_task_yield();
+}
+
+void task1(void)
+{
+	ucx_task_init();
+
+	for (;;)
+		ucx_task_yield();
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, cooperative mode
+	return 0;
+}
@@ -0,0 +1,57 @@
+#include <ucx.h>
+
+void task(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		_delay_ms(10);
+	}
+}
+
+void interactive(void)
+{
+	int32_t cnt = 0;
+
+	ucx_task_init();
+
+	while (1) {
+		printf("[task %d %ld]\n", ucx_task_id(), cnt++);
+		ucx_task_delay(50);
+	}
+}
+
+/* decodes scheduler events, when there is nothing else to run */
+void trace(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		ucx_trace_dump();
+		ucx_task_delay(10);
+	}
+}
+
+int32_t app_main(void)
+{
+	int32_t srv;
+
+	ucx_task_add_periodic(task, 100, 30, 100, DEFAULT_GUARD_SIZE);
+	ucx_task_add_periodic(task, 200, 60, 200, DEFAULT_GUARD_SIZE);
+
+	/* 20% of the processor for a group of aperiodic tasks */
+	srv = ucx_cbs_create(10, 50);
+	ucx_task_add(interactive, DEFAULT_GUARD_SIZE);
+	ucx_task_cbs(ucx_task_id(), srv);
+	ucx_task_add(interactive, DEFAULT_GUARD_SIZE);
+	ucx_task_cbs(ucx_task_id(), srv);
+
+	/* background task, runs when there is no ready job */
+	ucx_task_add(task, DEFAULT_GUARD_SIZE);
+
+	ucx_task_add(trace, DEFAULT_GUARD_SIZE);
+	ucx_task_priority(ucx_task_id(), TASK_LOW_PRIO);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
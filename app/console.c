@@ -0,0 +1,72 @@
+#include <ucx.h>
+
+#define LINES		16
+
+/* reports the time a line takes to print. with UCX_CONSOLE, printf() only
+ * copies the line to the console buffer, which is sent by the UART
+ * transmit interrupt while the task does something else. */
+void task0(void)
+{
+	uint32_t start, cycles = 0, lines = 0;
+
+	ucx_task_init();
+
+	for (;;) {
+		start = _readcounter();
+		printf("task 0: the quick brown fox jumps over the lazy dog (%ld)\n", lines);
+		cycles += _readcounter() - start;
+		if (++lines % LINES == 0) {
+			printf("task 0: %ld cycles per line\n", cycles / LINES);
+			cycles = 0;
+		}
+		ucx_task_delay(10);
+	}
+}
+
+/* prints bursts that may not fit in the console buffer. the task blocks
+ * until there is space (CONSOLE_BLOCK), or the output that doesn't fit
+ * is dropped (CONSOLE_DROP). */
+void task1(void)
+{
+	uint8_t policy = CONSOLE_BLOCK;
+	int32_t i;
+
+	ucx_task_init();
+
+	for (;;) {
+		ucx_task_delay(100);
+		ucx_console_policy(policy);
+		for (i = 0; i < LINES; i++)
+			printf("task 1: burst line %ld, %s\n", i, policy == CONSOLE_DROP ? "dropped if there is no space" : "blocks until there is space");
+		ucx_console_policy(CONSOLE_BLOCK);
+		printf("task 1: %ld bytes dropped\n", ucx_console_dropped());
+		policy = policy == CONSOLE_DROP ? CONSOLE_BLOCK : CONSOLE_DROP;
+	}
+}
+
+/* reads commands from the console. with UCX_CONSOLE, the task sleeps
+ * until characters are received, instead of polling the UART. */
+void task2(void)
+{
+	char line[80];
+
+	ucx_task_init();
+
+	for (;;) {
+		if (!getline(line))
+			continue;
+		if (!strcmp(line, "dropped"))
+			printf("task 2: %ld bytes dropped\n", ucx_console_dropped());
+		else
+			printf("task 2: unknown command '%s'\n", line);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task2, DEFAULT_GUARD_SIZE);
+
+	return 1;
+}
@@ -11,6 +11,17 @@ void task(void)
 	}
 }
 
+/* decodes scheduler events, when there is nothing else to run */
+void trace(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		ucx_trace_dump();
+		ucx_task_delay(10);
+	}
+}
+
 int32_t app_main(void)
 {
 	// Task group 0
@@ -34,6 +45,9 @@ int32_t app_main(void)
 	ucx_task_add_periodic(task, 200, 30, 140, DEFAULT_GUARD_SIZE);
 	ucx_task_add_periodic(task, 100, 10, 100, DEFAULT_GUARD_SIZE);
 
+	ucx_task_add(trace, DEFAULT_GUARD_SIZE);
+	ucx_task_priority(ucx_task_id(), TASK_LOW_PRIO);
+
 	// start UCX/OS, preemptive mode
 	return 1;
 }
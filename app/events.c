@@ -0,0 +1,72 @@
+#include <ucx.h>
+
+#define EV_SENSOR0	0x01
+#define EV_SENSOR1	0x02
+#define EV_ALARM	0x80
+
+struct event_s *ev;
+
+void sensor0(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		ucx_task_delay(20);
+		ucx_event_set(ev, EV_SENSOR0);
+	}
+}
+
+void sensor1(void)
+{
+	int32_t cnt = 0;
+
+	ucx_task_init();
+
+	while (1) {
+		ucx_task_delay(30);
+		ucx_event_set(ev, EV_SENSOR1);
+		if (++cnt % 10 == 0)
+			ucx_event_set(ev, EV_ALARM);
+	}
+}
+
+/* waits for a new sample of both sensors, no polling */
+void task0(void)
+{
+	uint32_t flags;
+
+	ucx_task_init();
+
+	while (1) {
+		flags = ucx_event_wait(ev, EV_SENSOR0 | EV_SENSOR1, EVENT_ALL | EVENT_CLEAR);
+		printf("task %d: both sensors ready (flags %02x)\n", ucx_task_id(), (long)flags);
+	}
+}
+
+/* waits for an alarm, or for any sensor */
+void task1(void)
+{
+	uint32_t flags;
+
+	ucx_task_init();
+
+	while (1) {
+		flags = ucx_event_wait(ev, EV_ALARM, EVENT_ANY | EVENT_CLEAR);
+		printf("task %d: alarm! (flags %02x)\n", ucx_task_id(), (long)flags);
+		flags = ucx_event_wait(ev, EV_SENSOR0 | EV_SENSOR1, EVENT_ANY);
+		printf("task %d: a sensor is ready after the alarm (flags %02x)\n", ucx_task_id(), (long)flags);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(sensor0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(sensor1, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	ev = ucx_event_create();
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,67 @@
+#include <ucx.h>
+
+#define BLOCKS		16
+
+void report(void)
+{
+	struct heap_stats_s stats;
+
+	ucx_heap_stats(&stats);
+	printf("\nheap: %ld free, %ld used (peak %ld), largest %ld, %ld fragments, %ld allocs / %ld frees / %ld failed",
+		stats.free, stats.used, stats.peak, stats.largest, stats.fragments,
+		stats.allocs, stats.frees, stats.failures);
+#ifdef UCX_TASK_STATS
+	{
+		struct task_stats_s ts;
+		int32_t i;
+
+		for (i = 0; i < ucx_task_count(); i++)
+			if (!ucx_task_stats(i, &ts))
+				printf("\ntask %ld: %ld bytes", i, ts.heap);
+	}
+#endif
+}
+
+void task0(void)
+{
+	void *block[BLOCKS];
+	int32_t i;
+
+	ucx_task_init();
+
+	for (i = 0; i < BLOCKS; i++)
+		block[i] = malloc(32 + (random() & 0xff));
+
+	while (1) {
+		/* replace every other block, this fragments the heap */
+		for (i = 0; i < BLOCKS; i += 2) {
+			free(block[i]);
+			block[i] = malloc(32 + (random() & 0xff));
+		}
+		report();
+		ucx_task_delay(100);
+	}
+}
+
+void task1(void)
+{
+	char *buf;
+
+	ucx_task_init();
+
+	while (1) {
+		buf = malloc(1024);
+		ucx_task_delay(50);
+		free(buf);
+		ucx_task_delay(50);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
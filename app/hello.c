@@ -18,9 +18,11 @@ void task1(void)
 
 	ucx_task_init();
 
+	/* a higher priority task always runs first, so it waits a bit
+	 * after each line to let the other tasks run */
 	while (1) {
 		printf("[task 1 %ld]\n", cnt++);
-		ucx_task_yield();
+		ucx_task_delay(2);
 	}
 }
 
@@ -11,6 +11,8 @@ void task2(void)
 	}
 }
 
+/* task 2 has a lower priority, so it only runs while tasks 0 and 1 are
+ * delayed */
 void task1(void)
 {
 	int32_t cnt = 200000;
@@ -19,6 +21,7 @@ void task1(void)
 
 	while (1) {
 		printf("[task %d %ld]\n", ucx_task_id(), cnt++);
+		ucx_task_delay(5);
 	}
 }
 
@@ -30,6 +33,7 @@ void task0(void)
 
 	while (1) {
 		printf("[task %d %ld]\n", ucx_task_id(), cnt++);
+		ucx_task_delay(5);
 	}
 }
 
@@ -0,0 +1,61 @@
+#include <ucx.h>
+
+struct frame_s {
+	uint32_t seq;
+	int16_t sample[8];
+};
+
+struct mbox_s *mbox1;
+
+void task0(void)
+{
+	struct frame_s *frame;
+	uint32_t seq = 0;
+	int32_t i;
+
+	ucx_task_init();
+
+	while (1) {
+		/* fill a message in place, no copies */
+		frame = ucx_mbox_alloc(mbox1);
+		if (!frame) {
+			printf("\nno free frames");
+			ucx_task_delay(10);
+			continue;
+		}
+		frame->seq = seq++;
+		for (i = 0; i < 8; i++)
+			frame->sample[i] = random() & 0xff;
+		ucx_mbox_post(mbox1, frame);
+		
+		ucx_task_delay(5);
+	}
+}
+
+void task1(void)
+{
+	struct frame_s *frame;
+	int32_t i, sum;
+
+	ucx_task_init();
+
+	while (1) {
+		/* blocks until a message is posted */
+		frame = ucx_mbox_recv(mbox1);
+		for (i = 0, sum = 0; i < 8; i++)
+			sum += frame->sample[i];
+		printf("\nframe %ld, sum %ld (%ld pending)", frame->seq, sum, ucx_mbox_count(mbox1));
+		ucx_mbox_free(mbox1, frame);
+	}
+}
+
+int32_t app_main(void)
+{
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	mbox1 = ucx_mbox_create(sizeof(struct frame_s), 4);	/* 4 frames */
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -1,28 +1,55 @@
 #include <ucx.h>
 
-struct sem_s *mutex;
+struct mutex_s *mutex;
+volatile int32_t b_runs = 0;
 
-void task_a(void)
+/* holds the mutex for a while. it only runs when task A and task B are
+ * not ready, unless it inherits the priority of task A. */
+void task_low(void)
 {
+	volatile int32_t i;
+
 	ucx_task_init();
 
 	for (;;) {
-		ucx_wait(mutex);
-		printf("hello from task A, id %d\n", ucx_task_id());
-		printf("this is still task A!\n");
-		ucx_signal(mutex);
+		ucx_mutex_lock(mutex);
+		printf("hello from task LOW, id %d\n", ucx_task_id());
+		for (i = 0; i < 100000; i++);
+		printf("this is still task LOW!\n");
+		ucx_mutex_unlock(mutex);
 	}
 }
 
+/* runs for a long time, keeping task LOW from running */
 void task_b(void)
 {
+	volatile int32_t i;
+
 	ucx_task_init();
 
 	for (;;) {
-		ucx_wait(mutex);
+		ucx_task_delay(10);
 		printf("hello from task B, id %d\n", ucx_task_id());
+		for (i = 0; i < 100000000; i++);
 		printf("this is still task B!\n");
-		ucx_signal(mutex);
+		b_runs++;
+	}
+}
+
+void task_a(void)
+{
+	int32_t runs;
+
+	ucx_task_init();
+
+	/* with priority inheritance, task B doesn't run while task A waits */
+	for (;;) {
+		ucx_task_delay(20);
+		runs = b_runs;
+		ucx_mutex_lock(mutex);
+		printf("hello from task A, id %d (task B ran %ld times while waiting)\n", ucx_task_id(), b_runs - runs);
+		printf("this is still task A!\n");
+		ucx_mutex_unlock(mutex);
 	}
 }
 
@@ -30,8 +57,12 @@ int32_t app_main(void)
 {
 	ucx_task_add(task_a, DEFAULT_GUARD_SIZE);
 	ucx_task_add(task_b, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task_low, DEFAULT_GUARD_SIZE);
+
+	ucx_task_priority(0, TASK_HIGH_PRIO);
+	ucx_task_priority(2, TASK_LOW_PRIO);
+
+	mutex = ucx_mutex_create();
 
-	mutex = ucx_semcreate(1);
-	
 	return 1;
 }
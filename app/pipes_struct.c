@@ -39,8 +39,8 @@ void task0(void)
 	ucx_task_init();
 
 	while (1) {
-		while (ucx_pipe_size(pipe1) < sizeof(struct data1_s));
-		s = ucx_pipe_read(pipe1, data, ucx_pipe_size(pipe1));
+		/* blocks until a whole struct is received */
+		s = ucx_pipe_read(pipe1, data, sizeof(struct data1_s));
 		printf("pipe (%d): %s %ld %d\n", s, ptr->v, ptr->a, ptr->b);
 	}
 }
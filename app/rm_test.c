@@ -0,0 +1,44 @@
+#include <ucx.h>
+
+void task(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		_delay_ms(10);
+	}
+}
+
+/* decodes scheduler events, when there is nothing else to run */
+void trace(void)
+{
+	ucx_task_init();
+
+	while (1) {
+		ucx_trace_dump();
+		ucx_task_delay(10);
+	}
+}
+
+int32_t app_main(void)
+{
+	/* rate monotonic, periods are checked at admission */
+	ucx_rt_policy(RT_POLICY_RM);
+
+	/* U = 0.75, below the bound for 3 tasks (0.7797) */
+	printf("task 0: %d\n", ucx_task_add_periodic(task, 100, 25, 100, DEFAULT_GUARD_SIZE));
+	printf("task 1: %d\n", ucx_task_add_periodic(task, 200, 50, 200, DEFAULT_GUARD_SIZE));
+	printf("task 2: %d\n", ucx_task_add_periodic(task, 400, 100, 400, DEFAULT_GUARD_SIZE));
+	
+	/* U = 0.95, above the bound but schedulable (harmonic periods) */
+	printf("task 3: %d\n", ucx_task_add_periodic(task, 400, 80, 400, DEFAULT_GUARD_SIZE));
+	
+	/* U > 1, rejected */
+	printf("task 4: %d\n", ucx_task_add_periodic(task, 200, 20, 200, DEFAULT_GUARD_SIZE));
+
+	ucx_task_add(trace, DEFAULT_GUARD_SIZE);
+	ucx_task_priority(ucx_task_id(), TASK_LOW_PRIO);
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
@@ -0,0 +1,77 @@
+#include <ucx.h>
+
+#define TIMERS		100
+
+struct timer_s *blink, *timeout, *timer[TIMERS];
+volatile uint32_t blinks = 0, timeouts = 0, count[TIMERS];
+int32_t timers = 0;
+
+/* callbacks run on the timer task, and should be short */
+void blink_cb(void *arg)
+{
+	blinks++;
+}
+
+void timeout_cb(void *arg)
+{
+	timeouts++;
+	printf("timeout! (%ld)\n", timeouts);
+}
+
+void count_cb(void *arg)
+{
+	count[(size_t)arg]++;
+}
+
+/* restarts a one-shot timer, which expires if not restarted in time */
+void task0(void)
+{
+	int32_t i;
+
+	ucx_task_init();
+
+	for (i = 0; ; i++) {
+		ucx_timer_start(timeout, 100, TIMER_ONESHOT);
+		ucx_task_delay(i % 4 ? 50 : 150);
+	}
+}
+
+void task1(void)
+{
+	uint32_t total;
+	int32_t i;
+
+	ucx_task_init();
+
+	while (1) {
+		ucx_task_delay(200);
+		for (total = 0, i = 0; i < TIMERS; i++)
+			total += count[i];
+		printf("blinks: %ld, timers: %ld, callbacks: %ld\n", blinks, timers, total);
+	}
+}
+
+int32_t app_main(void)
+{
+	int32_t i;
+
+	ucx_task_add(task0, DEFAULT_GUARD_SIZE);
+	ucx_task_add(task1, DEFAULT_GUARD_SIZE);
+
+	blink = ucx_timer_create(blink_cb, 0);
+	timeout = ucx_timer_create(timeout_cb, 0);
+	ucx_timer_start(blink, 50, TIMER_AUTORELOAD);
+
+	/* many timers, with different periods (fewer if the timer pool has a
+	 * fixed size, UCX_POOL_FIXED) */
+	for (i = 0; i < TIMERS; i++) {
+		timer[i] = ucx_timer_create(count_cb, (void *)(size_t)i);
+		if (!timer[i])
+			break;
+		ucx_timer_start(timer[i], 10 + i, TIMER_AUTORELOAD);
+		timers++;
+	}
+
+	// start UCX/OS, preemptive mode
+	return 1;
+}
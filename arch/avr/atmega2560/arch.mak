@@ -7,7 +7,7 @@ SERIAL_BAUDRATE=57600
 
 # this is stuff used everywhere - compiler and flags should be declared (ASFLAGS, CFLAGS, LDFLAGS, LD_SCRIPT, CC, AS, LD, DUMP, READ, OBJ and SIZE).
 ASFLAGS = 
-CFLAGS = -c -g -mmcu=atmega2560 -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UCX_OS_HEAP_SIZE=1024
+CFLAGS = -c -g -mmcu=atmega2560 -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UCX_OS_HEAP_SIZE=1024 -D UCX_POOL_SIZE=4 -D UCX_TRACE_SIZE=4 -D UCX_TIMER_WHEEL=8 -D UCX_CONSOLE_SIZE=64 -D UCX_CONSOLE_RX_SIZE=16
 
 LDFLAGS = -g -mmcu=atmega2560 -Wall -Os -fno-inline-small-functions -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast -Wno-main -fomit-frame-pointer -D F_CPU=$(F_CLK) -D USART_BAUD=$(SERIAL_BAUDRATE) $(INC_DIRS) -D UCX_OS_HEAP_SIZE=1024
 LDSCRIPT = 
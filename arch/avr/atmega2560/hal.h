@@ -26,6 +26,7 @@ void _hardware_init(void);
 void _timer_enable(void);
 void _timer_disable(void);
 void _interrupt_tick(void);
+void _console_tx_start(void);
 
 #define strcpy(dst, src)		ucx_strcpy(dst, src)
 #define strncpy(s1, s2, n)		ucx_strncpy(s1, s2, n)
@@ -43,6 +44,7 @@ void _interrupt_tick(void);
 #define memcpy(dst, src, n)		ucx_memcpy(dst, src, n)
 #define memmove(dst, src, n)		ucx_memmove(dst, src, n)
 #define memcmp(cs, ct, n)		ucx_memcmp(cs, ct, n)
+#define memchr(s, c, n)			ucx_memchr(s, c, n)
 #define memset(s, c, n)			ucx_memset(s, c, n)
 #define abs(n)				ucx_abs(n)
 #define random()			ucx_random()
@@ -59,5 +61,7 @@ void _interrupt_tick(void);
 #define realloc(p, s)			ucx_realloc(p, s)
 
 void krnl_dispatcher(void);
+int32_t krnl_console_tx(void);
+void krnl_console_rx(char c);
 
 #define DEFAULT_GUARD_SIZE	128
@@ -84,6 +84,8 @@ uint8_t uart_rx(void)
 	return data;
 }
 
+/* with UCX_CONSOLE, received data goes to the console buffer (hal.c) */
+#ifndef UCX_CONSOLE
 ISR(USART0_RX_vect)
 {
 	uint16_t tail;
@@ -101,3 +103,4 @@ ISR(USART0_RX_vect)
 		}
 	}
 }
+#endif
@@ -41,18 +41,60 @@ char _interrupt_set(char s)
 	return val;
 }
 
-/* kernel auxiliary routines */
+/* kernel auxiliary routines. interrupts are disabled in interrupt
+ * handlers, which is kept in int_status, so critical sections used by the
+ * kernel don't enable them */
 ISR(TIMER2_COMPA_vect)
 {
+	int_status = 0;
 	krnl_dispatcher();
+	int_status = 1;
 }
 
+#ifdef UCX_CONSOLE
+/* buffered console. received characters are moved to the console buffer.
+ * the data register is refilled from the console buffer when it is empty,
+ * and the interrupt is disabled when there is nothing left to send. */
+ISR(USART_RX_vect)
+{
+	char status = int_status;
+	
+	int_status = 0;
+	while (UCSR0A & (1 << RXC0))
+		krnl_console_rx(UDR0);
+	int_status = status;
+}
+
+ISR(USART_UDRE_vect)
+{
+	int32_t c;
+	char status = int_status;
+	
+	int_status = 0;
+	c = krnl_console_tx();
+	if (c < 0)
+		UCSR0B &= ~(1 << UDRIE0);
+	else
+		UDR0 = c;
+	int_status = status;
+}
+
+void _console_tx_start(void)
+{
+	UCSR0B |= (1 << UDRIE0);
+}
+#endif
+
 void _hardware_init(void)
 {
 	/* disable interrupts */
 	cli();
 	
+#ifdef UCX_CONSOLE
+	uart_init(USART_BAUD, 0);
+#else
 	uart_init(USART_BAUD, 1);
+#endif
 
 	TCNT2 = 0;
 	TCCR2A = 0;
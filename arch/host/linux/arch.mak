@@ -0,0 +1,26 @@
+# this is stuff specific to this architecture
+ARCH_DIR = $(SRC_DIR)/arch/$(ARCH)
+INC_DIRS  = -I $(ARCH_DIR)
+
+# tasks share the stack and switch with setjmp() / longjmp(), so longjmp()
+# checks, stack protectors and shadow stacks must be disabled
+CFLAGS_HOST = -U_FORTIFY_SOURCE -fno-stack-protector -fcf-protection=none -fno-builtin -fno-pie
+
+# this is stuff used everywhere - compiler and flags should be declared (ASFLAGS, CFLAGS, LDFLAGS, LD_SCRIPT, CC, AS, LD, DUMP, READ, OBJ and SIZE).
+ASFLAGS =
+CFLAGS = -Wall -O2 -g -c -fno-omit-frame-pointer -Wno-main $(CFLAGS_HOST) $(INC_DIRS) -DUCX_OS_HEAP_SIZE=1048576
+
+LDFLAGS = -g -no-pie
+LDSCRIPT =
+
+CC = gcc
+AS = as
+LD = gcc
+DUMP = objdump
+READ = readelf
+OBJ = objcopy
+SIZE = size
+
+hal:
+	$(CC) $(CFLAGS) \
+		$(ARCH_DIR)/hal.c
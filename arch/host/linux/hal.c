@@ -0,0 +1,273 @@
+/* file:          hal.c
+ * description:   hardware abstraction layer for a Linux host
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+/* the host is seen as a simple machine: the console is stdin / stdout,
+ * the tick interrupt is a SIGALRM from an interval timer (blocked while
+ * interrupts or the timer are disabled), the UART interrupts of the
+ * buffered console are a SIGUSR1 (transmit) and a SIGIO on stdin
+ * (receive) and the cycle counter is the
+ * monotonic clock, in nanoseconds. tasks share the process stack, as on
+ * any other target, so signal frames are pushed on the guard space of the
+ * running task. */
+
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <hal.h>
+
+static uint64_t tick_ref = 0;
+static int32_t int_enabled = 0, timer_enabled = 0;
+#ifdef UCX_CONSOLE
+static volatile int32_t rx_pending = 0;
+#endif
+
+static uint64_t clock_ns(void)
+{
+	struct timespec ts;
+	
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void timer_set(uint32_t value, uint32_t interval)
+{
+	struct itimerval it;
+	
+	it.it_value.tv_sec = value / 1000000;
+	it.it_value.tv_usec = value % 1000000;
+	it.it_interval.tv_sec = interval / 1000000;
+	it.it_interval.tv_usec = interval % 1000000;
+	setitimer(ITIMER_REAL, &it, 0);
+}
+
+/* the tick is delivered only if both interrupts and the timer are enabled,
+ * and the UART interrupts (SIGUSR1, SIGIO) if interrupts are enabled */
+static void int_update(void)
+{
+	sigset_t set;
+	
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	sigprocmask(int_enabled && timer_enabled ? SIG_UNBLOCK : SIG_BLOCK, &set, 0);
+#ifdef UCX_CONSOLE
+	sigemptyset(&set);
+	sigaddset(&set, SIGUSR1);
+	sigaddset(&set, SIGIO);
+	sigprocmask(int_enabled ? SIG_UNBLOCK : SIG_BLOCK, &set, 0);
+#endif
+}
+
+/* the dispatcher returns here only when it resumes a task preempted by a
+ * previous tick. the signal mask is then restored on the handler return */
+static void timer_handler(int sig)
+{
+	int_enabled = 0;
+#ifdef UCX_CONSOLE
+	if (rx_pending)
+		raise(SIGIO);
+#endif
+	krnl_dispatcher();
+	int_enabled = 1;
+}
+
+#ifdef UCX_CONSOLE
+/* buffered console. the UART receive interrupt is a signal raised when
+ * there is input on stdin, and each one receives up to a FIFO of
+ * characters. input left is received on the next tick (or when idle), so
+ * a stream of input doesn't keep the tasks from running. the transmit
+ * interrupt is a signal raised while there is something to send, and each
+ * one sends up to a FIFO of characters. */
+#define UART_FIFO	16
+
+static void uart_handler(int sig)
+{
+	struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+	char fifo[UART_FIFO];
+	int32_t c = 0, n = 0, i, k;
+	
+	int_enabled = 0;
+	if (poll(&fd, 1, 0) > 0 && (n = read(STDIN_FILENO, fifo, UART_FIFO)) > 0)
+		for (i = 0; i < n; i++)
+			krnl_console_rx(fifo[i]);
+	rx_pending = n == UART_FIFO;
+	
+	for (n = 0; n < UART_FIFO && (c = krnl_console_tx()) >= 0; n++)
+		fifo[n] = c;
+	for (i = 0; i < n;)
+		if ((k = write(STDOUT_FILENO, fifo + i, n - i)) > 0)
+			i += k;
+	if (c >= 0)
+		raise(SIGUSR1);
+	int_enabled = 1;
+}
+
+void _console_tx_start(void)
+{
+	raise(SIGUSR1);
+}
+#endif
+
+/* hardware platform dependent stuff */
+void _putchar(char value)
+{
+	while (write(STDOUT_FILENO, &value, 1) != 1);
+}
+
+int32_t _kbhit(void)
+{
+	struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+	
+	return poll(&fd, 1, 0) > 0;
+}
+
+int32_t _getchar(void)
+{
+	char value;
+	
+	while (read(STDIN_FILENO, &value, 1) != 1);
+	
+	return value;
+}
+
+int32_t _interrupt_set(int32_t s)
+{
+	int32_t old = int_enabled;
+	
+	int_enabled = s;
+	int_update();
+	
+	return old;
+}
+
+void _delay_ms(uint32_t msec)
+{
+	_delay_us(msec * 1000);
+}
+
+void _delay_us(uint32_t usec)
+{
+	uint64_t end = clock_ns() + (uint64_t)usec * 1000;
+	
+	while (clock_ns() < end);
+}
+
+/* waits for a pending tick (or UART interrupt), with interrupts disabled */
+void _cpu_idle(void)
+{
+	sigset_t set;
+	
+#ifdef UCX_CONSOLE
+	if (rx_pending) {
+		raise(SIGIO);
+		return;
+	}
+#endif
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+#ifdef UCX_CONSOLE
+	sigaddset(&set, SIGUSR1);
+	sigaddset(&set, SIGIO);
+#endif
+	raise(sigwaitinfo(&set, 0));
+}
+
+uint32_t _readcounter(void)
+{
+	return (uint32_t)clock_ns();
+}
+
+uint64_t _read_us(void)
+{
+	return clock_ns() / 1000;
+}
+
+uint32_t _timer_ticks(void)
+{
+	uint64_t delta;
+	uint32_t ticks;
+	
+	delta = _read_us() - tick_ref;
+	if (delta < 2 * TIMER_TICK)
+		ticks = delta >= TIMER_TICK ? 1 : 0;
+	else
+		ticks = delta / TIMER_TICK;
+	tick_ref += (uint64_t)ticks * TIMER_TICK;
+	
+	return ticks;
+}
+
+void _timer_oneshot(uint32_t ticks)
+{
+	int64_t value;
+	
+	value = (int64_t)(tick_ref + (uint64_t)ticks * TIMER_TICK - _read_us());
+	timer_set(value > 0 ? value : 1, 0);
+}
+
+void _panic(void)
+{
+	exit(1);
+}
+
+void _hardware_init(void)
+{
+	struct sigaction sa;
+	
+	int_update();
+	sa.sa_handler = timer_handler;
+	sa.sa_flags = 0;
+	sigemptyset(&sa.sa_mask);
+#ifdef UCX_CONSOLE
+	sigaddset(&sa.sa_mask, SIGUSR1);
+	sigaddset(&sa.sa_mask, SIGIO);
+#endif
+	sigaction(SIGALRM, &sa, 0);
+#ifdef UCX_CONSOLE
+	sa.sa_handler = uart_handler;
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIGALRM);
+	sigaddset(&sa.sa_mask, SIGUSR1);
+	sigaddset(&sa.sa_mask, SIGIO);
+	sigaction(SIGUSR1, &sa, 0);
+	sigaction(SIGIO, &sa, 0);
+	
+	/* input that is already there doesn't raise a SIGIO */
+	fcntl(STDIN_FILENO, F_SETOWN, getpid());
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_ASYNC);
+	raise(SIGIO);
+#endif
+	
+	tick_ref = _read_us();
+#ifdef UCX_TICKLESS
+	timer_set(TIMER_TICK, 0);
+#else
+	timer_set(TIMER_TICK, TIMER_TICK);
+#endif
+}
+
+void _timer_enable(void)
+{
+	timer_enabled = 1;
+	int_update();
+}
+
+void _timer_disable(void)
+{
+	timer_enabled = 0;
+	int_update();
+}
+
+/* the dispatcher leaves the signal handler with longjmp(), so the signal
+ * is unblocked here */
+void _interrupt_tick(void)
+{
+	_ei(1);
+}
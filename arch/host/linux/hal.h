@@ -0,0 +1,77 @@
+/* file:          hal.h
+ * description:   hardware abstraction layer (HAL) definitions for a Linux host
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#define __ARCH__	"Linux host"
+
+/* disable interrupts, return previous int status / enable interrupts */
+#define _di()				_interrupt_set(0)
+#define _ei(S)				_interrupt_set(S)
+
+#define TIMER_TICK			10000		/* tick period, in microseconds */
+
+int32_t _interrupt_set(int32_t s);
+
+void _putchar(char value);
+int32_t _kbhit(void);
+int32_t _getchar(void);
+
+void _delay_ms(uint32_t msec);
+void _delay_us(uint32_t usec);
+
+void _hardware_init(void);
+void _timer_enable(void);
+void _timer_disable(void);
+void _interrupt_tick(void);
+void _cpu_idle(void);
+uint32_t _readcounter(void);
+uint64_t _read_us(void);
+uint32_t _timer_ticks(void);
+void _timer_oneshot(uint32_t ticks);
+void _console_tx_start(void);
+void _panic(void);
+
+#define strcpy(dst, src)		ucx_strcpy(dst, src)
+#define strncpy(s1, s2, n)		ucx_strncpy(s1, s2, n)
+#define strcat(dst, src)		ucx_strcat(dst, src)
+#define strncat(dst, src, n)		ucx_strncat(dst, src, n)
+#define strcmp(s1, s2)			ucx_strcmp(s1, s2)
+#define strncmp(s1, s2, n)		ucx_strncmp(s1, s2, n)
+#define strstr(string, find)		ucx_strstr(string, find)
+#define strlen(s)			ucx_strlen(s)
+#define strchr(s, c)			ucx_strchr(s, c)
+#define strpbrk(str, set)		ucx_strpbrk(str, set)
+#define strsep(pp, delim)		ucx_strsep(pp, delim)
+#define strtok(s, delim)		ucx_strtok(s, delim)
+#define strtol(s, end, base)		ucx_strtol(s, end, base)
+#define memcpy(dst, src, n)		ucx_memcpy(dst, src, n)
+#define memmove(dst, src, n)		ucx_memmove(dst, src, n)
+#define memcmp(cs, ct, n)		ucx_memcmp(cs, ct, n)
+#define memchr(s, c, n)			ucx_memchr(s, c, n)
+#define memset(s, c, n)			ucx_memset(s, c, n)
+#define abs(n)				ucx_abs(n)
+#define random()			ucx_random()
+#define srand(seed)			ucx_srand(seed)
+#define puts(str)			ucx_puts(str)
+#define gets(s)				ucx_gets(s)
+#define getline(s)			ucx_getline(s)
+#define printf(fmt, ...)		ucx_printf(fmt, ##__VA_ARGS__)
+#define sprintf(out, fmt, ...)		ucx_sprintf(out, fmt, ##__VA_ARGS__)
+
+#define malloc(n)			ucx_malloc(n)
+#define free(n)				ucx_free(n)
+#define calloc(n, t)			ucx_calloc(n, t) 
+#define realloc(p, s)			ucx_realloc(p, s)
+
+void krnl_dispatcher(void);
+int32_t krnl_console_tx(void);
+void krnl_console_rx(char c);
+
+/* signal frames are kept on the stack of the interrupted task */
+#define DEFAULT_GUARD_SIZE	16384
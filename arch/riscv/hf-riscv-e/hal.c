@@ -404,3 +404,8 @@ void _interrupt_tick(void)
 {
 	_ei(1);
 }
+
+uint32_t _readcounter(void)
+{
+	return TIMER0;
+}
@@ -381,6 +381,7 @@ void _hardware_init(void);
 void _timer_enable(void);
 void _timer_disable(void);
 void _interrupt_tick(void);
+uint32_t _readcounter(void);
 
 #define strcpy(dst, src)		ucx_strcpy(dst, src)
 #define strncpy(s1, s2, n)		ucx_strncpy(s1, s2, n)
@@ -398,6 +399,7 @@ void _interrupt_tick(void);
 #define memcpy(dst, src, n)		ucx_memcpy(dst, src, n)
 #define memmove(dst, src, n)		ucx_memmove(dst, src, n)
 #define memcmp(cs, ct, n)		ucx_memcmp(cs, ct, n)
+#define memchr(s, c, n)			ucx_memchr(s, c, n)
 #define memset(s, c, n)			ucx_memset(s, c, n)
 #define abs(n)				ucx_abs(n)
 #define random()			ucx_random()
@@ -37,7 +37,7 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define read_csr(reg) ({ uint32_t __tmp; asm volatile ("csrr %0, " #reg : "=r"(__tmp)); __tmp; })
 #define write_csr(reg, val) ({ asm volatile ("csrw " #reg ", %0" :: "rK"(val)); })
 
-#define NS16550A_UART0_CTRL_ADDR(a)	*(uint8_t*) (0x10000000 + (a))
+#define NS16550A_UART0_CTRL_ADDR(a)	*(volatile uint8_t*) (0x10000000 + (a))
 #define NS16550A_RBR			0x00
 #define NS16550A_THR      		0x00
 #define NS16550A_IER      		0x01
@@ -49,6 +49,10 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define NS16550A_LSR      		0x05
 #define NS16550A_MSR      		0x06
 #define NS16550A_SCR      		0x07
+#define NS16550A_IER_RDI		0x01
+#define NS16550A_IER_THRI		0x02
+#define NS16550A_FCR_FIFO		0x07		/* enable and clear FIFOs */
+#define NS16550A_FIFO_SIZE		16
 #define NS16550A_LCR_DLAB 		0x80
 #define NS16550A_LCR_8BIT 		0x03
 #define NS16550A_LCR_PODD 		0x08
@@ -61,6 +65,12 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define NS16550A_LSR_RI   		0x40
 #define NS16550A_LSR_EF   		0x80
 
+#define PLIC_PRIORITY(irq)		(*(volatile uint32_t *)(0x0c000000 + 4 * (irq)))
+#define PLIC_ENABLE			(*(volatile uint32_t *)(0x0c002000))	/* hart 0, machine mode */
+#define PLIC_THRESHOLD			(*(volatile uint32_t *)(0x0c200000))
+#define PLIC_CLAIM			(*(volatile uint32_t *)(0x0c200004))
+#define PLIC_UART0_IRQ			10
+
 #define MTIME				(*(volatile uint64_t *)(0x0200bff8))
 #define MTIMECMP			(*(volatile uint64_t *)(0x02004000))
 #define MTIME_L				(*(volatile uint32_t *)(0x0200bff8))
@@ -68,6 +78,8 @@ extern uint32_t _end;			/* Start address of the heap memory, defined in linker s
 #define MTIMECMP_L			(*(volatile uint32_t *)(0x02004000))
 #define MTIMECMP_H			(*(volatile uint32_t *)(0x02004004))
 
+#define TIMER_TICK			0x1ffff		/* timer cycles per tick */
+
 /* hardware dependent C library stuff */
 typedef uint32_t jmp_buf[20];
 
@@ -86,6 +98,13 @@ void _hardware_init(void);
 void _timer_enable(void);
 void _timer_disable(void);
 void _interrupt_tick(void);
+void _cpu_idle(void);
+uint32_t _readcounter(void);
+/* CPU cycles (instructions with -icount), _readcounter() counts timer ticks */
+#define _readcycles()		read_csr(mcycle)
+uint32_t _timer_ticks(void);
+void _timer_oneshot(uint32_t ticks);
+void _console_tx_start(void);
 
 uint64_t mtime_r(void);
 void mtime_w(uint64_t val);
@@ -108,6 +127,7 @@ void mtimecmp_w(uint64_t val);
 #define memcpy(dst, src, n)		ucx_memcpy(dst, src, n)
 #define memmove(dst, src, n)		ucx_memmove(dst, src, n)
 #define memcmp(cs, ct, n)		ucx_memcmp(cs, ct, n)
+#define memchr(s, c, n)			ucx_memchr(s, c, n)
 #define memset(s, c, n)			ucx_memset(s, c, n)
 #define abs(n)				ucx_abs(n)
 #define random()			ucx_random()
@@ -124,5 +144,7 @@ void mtimecmp_w(uint64_t val);
 #define realloc(p, s)			ucx_realloc(p, s)
 
 void krnl_dispatcher(void);
+int32_t krnl_console_tx(void);
+void krnl_console_rx(char c);
 
 #define DEFAULT_GUARD_SIZE	4096
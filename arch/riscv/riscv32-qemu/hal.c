@@ -289,6 +289,8 @@ int64_t __divdi3(int64_t num, int64_t den){
 	return v;
 }
 
+static uint64_t tick_ref = 0;
+
 /* hardware platform dependent stuff */
 void _putchar(char value)		// polled putchar()
 {
@@ -298,12 +300,14 @@ void _putchar(char value)		// polled putchar()
 
 int32_t _kbhit(void)
 {
-	return 0;
+	return (NS16550A_UART0_CTRL_ADDR(NS16550A_LSR) & NS16550A_LSR_DA) ? 1 : 0;
 }
 
-int32_t _getchar(void)
+int32_t _getchar(void)			// polled getch()
 {
-	return 0;
+	while (!_kbhit());
+	
+	return NS16550A_UART0_CTRL_ADDR(NS16550A_RBR);
 }
 
 int32_t _interrupt_set(int32_t s)
@@ -374,6 +378,47 @@ static void uart_init(uint32_t baud)
 	NS16550A_UART0_CTRL_ADDR(NS16550A_LCR) = NS16550A_LCR_8BIT;
 }
 
+#ifdef UCX_CONSOLE
+/* buffered console. received characters are moved to the console buffer.
+ * the transmit FIFO is refilled from the console buffer when it is empty,
+ * and the interrupt is disabled when there is nothing left to send. */
+static void uart_irq(void)
+{
+	int32_t c, i;
+	
+	while (NS16550A_UART0_CTRL_ADDR(NS16550A_LSR) & NS16550A_LSR_DA)
+		krnl_console_rx(NS16550A_UART0_CTRL_ADDR(NS16550A_RBR));
+	
+	if (!(NS16550A_UART0_CTRL_ADDR(NS16550A_IER) & NS16550A_IER_THRI) ||
+		!(NS16550A_UART0_CTRL_ADDR(NS16550A_LSR) & NS16550A_LSR_RE))
+		return;
+	
+	for (i = 0; i < NS16550A_FIFO_SIZE; i++) {
+		c = krnl_console_tx();
+		if (c < 0) {
+			NS16550A_UART0_CTRL_ADDR(NS16550A_IER) &= ~NS16550A_IER_THRI;
+			break;
+		}
+		NS16550A_UART0_CTRL_ADDR(NS16550A_THR) = c;
+	}
+}
+
+static void ext_irq(void)
+{
+	uint32_t irq;
+	
+	irq = PLIC_CLAIM;
+	if (irq == PLIC_UART0_IRQ)
+		uart_irq();
+	PLIC_CLAIM = irq;
+}
+
+void _console_tx_start(void)
+{
+	NS16550A_UART0_CTRL_ADDR(NS16550A_IER) |= NS16550A_IER_THRI;
+}
+#endif
+
 void _cpu_idle(void)
 {
 	asm volatile ("wfi");
@@ -384,8 +429,17 @@ void _irq_handler(uint32_t cause, uint32_t *stack)
 	uint32_t val;
 	
 	val = read_csr(mcause);
-	if (mtime_r() > mtimecmp_r()) {
-		mtimecmp_w(mtime_r() + 0x1ffff);
+#ifdef UCX_CONSOLE
+	/* machine external interrupt */
+	if ((val & 0xff) == 11) {
+		ext_irq();
+		return;
+	}
+#endif
+	if (mtime_r() >= mtimecmp_r()) {
+#ifndef UCX_TICKLESS
+		mtimecmp_w(mtime_r() + TIMER_TICK);
+#endif
 		krnl_dispatcher();
 	} else {
 		printf("[%x]\n", val);
@@ -450,6 +504,28 @@ void mtimecmp_w(uint64_t val)
 	MTIMECMP_L = (uint32_t)(val & 0xffffffff);
 }
 
+/* tickless operation. the tick reference is kept on a tick boundary, so
+ * the timer can be programmed many ticks ahead without drifting. */
+uint32_t _timer_ticks(void)
+{
+	uint64_t delta;
+	uint32_t ticks;
+	
+	delta = mtime_r() - tick_ref;
+	if (delta < 2 * TIMER_TICK)
+		ticks = delta >= TIMER_TICK ? 1 : 0;
+	else
+		ticks = delta / TIMER_TICK;
+	tick_ref += (uint64_t)ticks * TIMER_TICK;
+	
+	return ticks;
+}
+
+void _timer_oneshot(uint32_t ticks)
+{
+	mtimecmp_w(tick_ref + (uint64_t)ticks * TIMER_TICK);
+}
+
 void _panic(void)
 {
 	volatile int * const exit_device = (int* const)0x100000;
@@ -460,8 +536,18 @@ void _panic(void)
 void _hardware_init(void)
 {
 	uart_init(TERM_BAUD);
-	mtimecmp_w(mtime_r() + 0x1ffff);
+	tick_ref = mtime_r();
+	mtimecmp_w(tick_ref + TIMER_TICK);
+#ifdef UCX_CONSOLE
+	NS16550A_UART0_CTRL_ADDR(NS16550A_FCR) = NS16550A_FCR_FIFO;
+	NS16550A_UART0_CTRL_ADDR(NS16550A_IER) = NS16550A_IER_RDI;
+	PLIC_PRIORITY(PLIC_UART0_IRQ) = 1;
+	PLIC_THRESHOLD = 0;
+	PLIC_ENABLE = 1 << PLIC_UART0_IRQ;
+	write_csr(mie, 128 | 2048);
+#else
 	write_csr(mie, 128);
+#endif
 }
 
 void _timer_enable(void)
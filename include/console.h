@@ -0,0 +1,31 @@
+/* console buffer sizes, in bytes (power of 2) */
+#ifndef UCX_CONSOLE_SIZE
+#define UCX_CONSOLE_SIZE	256
+#endif
+#ifndef UCX_CONSOLE_RX_SIZE
+#define UCX_CONSOLE_RX_SIZE	64
+#endif
+
+/* console overflow policies */
+enum {CONSOLE_BLOCK, CONSOLE_DROP};
+
+/* console input and output, buffered (UCX_CONSOLE) or polled */
+#ifdef UCX_CONSOLE
+#define console_putchar(c)		ucx_console_putchar(c)
+#define console_getchar()		ucx_console_getchar()
+#else
+#define console_putchar(c)		_putchar(c)
+#define console_getchar()		_getchar()
+#endif
+
+int32_t ucx_console_write(char *buf, uint32_t size);
+int32_t ucx_console_putchar(char c);
+int32_t ucx_console_read(char *buf, uint32_t size);
+int32_t ucx_console_getchar(void);
+int32_t ucx_console_policy(uint8_t policy);
+void ucx_console_flush(void);
+uint32_t ucx_console_dropped(void);
+
+void krnl_console_init(void);
+int32_t krnl_console_tx(void);
+void krnl_console_rx(char c);
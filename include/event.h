@@ -0,0 +1,26 @@
+/* wait options */
+#define EVENT_ANY		0x00			/* any of the flags */
+#define EVENT_ALL		0x01			/* all of the flags */
+#define EVENT_CLEAR		0x02			/* clear the flags waited for on exit */
+
+/* a task blocked on an event group (on the task stack) */
+struct event_wait_s {
+	struct event_wait_s *next;
+	struct tcb_s *tcb;
+	uint32_t mask;
+	uint32_t flags;				/* flags that woke the task */
+	uint8_t mode;
+};
+
+struct event_s {
+	volatile uint32_t flags;
+	struct event_wait_s *waiters;
+};
+
+struct event_s *ucx_event_create(void);
+int32_t ucx_event_destroy(struct event_s *ev);
+uint32_t ucx_event_wait(struct event_s *ev, uint32_t mask, uint8_t mode);
+uint32_t ucx_event_set(struct event_s *ev, uint32_t mask);
+uint32_t ucx_event_set_isr(struct event_s *ev, uint32_t mask);
+uint32_t ucx_event_clear(struct event_s *ev, uint32_t mask);
+uint32_t ucx_event_get(struct event_s *ev);
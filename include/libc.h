@@ -56,6 +56,7 @@ int32_t ucx_strtol(char *s, char **end, int32_t base);
 void *ucx_memcpy(void *dst, void *src, uint32_t n);
 void *ucx_memmove(void *dst, void *src, uint32_t n);
 int32_t ucx_memcmp(void *cs, void *ct, uint32_t n);
+void *ucx_memchr(void *s, int32_t c, uint32_t n);
 void *ucx_memset(void *s, int32_t c, uint32_t n);
 int32_t ucx_abs(int32_t n);
 int32_t ucx_random(void);
@@ -0,0 +1,16 @@
+struct mbox_s {
+	struct pool_s *pool;			/* message blocks */
+	void **slots;				/* posted messages, in order */
+	uint16_t count;
+	uint16_t head, tail, posted;
+	struct tcb_s *rx_wait;			/* tasks blocked on a receive */
+};
+
+struct mbox_s *ucx_mbox_create(uint16_t msg_size, uint16_t count);
+int32_t ucx_mbox_destroy(struct mbox_s *mbox);
+void *ucx_mbox_alloc(struct mbox_s *mbox);
+void ucx_mbox_free(struct mbox_s *mbox, void *msg);
+int32_t ucx_mbox_post(struct mbox_s *mbox, void *msg);
+void *ucx_mbox_recv(struct mbox_s *mbox);
+void *ucx_mbox_tryrecv(struct mbox_s *mbox);
+int32_t ucx_mbox_count(struct mbox_s *mbox);
@@ -5,6 +5,22 @@ typedef unsigned long size_t;
 struct mem_block_s {
 	struct mem_block_s *next;		/* pointer to the next block */
 	size_t size;				/* aligned block size. the LSB is used to define if the block is used */
+#ifdef UCX_TASK_STATS
+	struct tcb_s *owner;			/* task that allocated the block */
+#endif
+};
+
+/* heap usage, in bytes (block headers not included) */
+struct heap_stats_s {
+	uint32_t size;				/* heap size */
+	uint32_t free;				/* free */
+	uint32_t used;				/* in use */
+	uint32_t peak;				/* peak usage */
+	uint32_t largest;			/* largest free block */
+	uint32_t fragments;			/* free blocks */
+	uint32_t allocs;			/* successful allocations */
+	uint32_t frees;
+	uint32_t failures;			/* failed allocations */
 };
 
 void ucx_free(void *ptr);
@@ -12,6 +28,13 @@ void *ucx_malloc(uint32_t size);
 void ucx_heap_init(size_t *zone, uint32_t len);
 void *ucx_calloc(uint32_t size, uint32_t type_size);
 void *ucx_realloc(void *ptr, uint32_t size);
+void ucx_heap_stats(struct heap_stats_s *stats);
+
+/* allocator internal API */
+struct tcb_s *heap_account_alloc(uint32_t size);
+void heap_account_fail(void);
+void heap_account_free(struct tcb_s *owner, uint32_t size);
+void heap_account_resize(struct tcb_s *owner, uint32_t old, uint32_t size);
 
 #ifdef UCX_OS_HEAP_SIZE
 extern char _heap[UCX_OS_HEAP_SIZE];
@@ -0,0 +1,12 @@
+struct mutex_s {
+	struct tcb_s *owner;
+	struct tcb_s *waiters;			/* blocked tasks, most urgent first */
+	struct mutex_s *next;			/* next mutex held by the owner */
+	uint16_t count;				/* recursive locks */
+};
+
+struct mutex_s *ucx_mutex_create(void);
+int32_t ucx_mutex_destroy(struct mutex_s *m);
+int32_t ucx_mutex_lock(struct mutex_s *m);
+int32_t ucx_mutex_trylock(struct mutex_s *m);
+int32_t ucx_mutex_unlock(struct mutex_s *m);
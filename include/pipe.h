@@ -2,10 +2,15 @@ struct pipe_s {
 	char *data;
 	uint32_t mask;				/* size must be a power of 2 */
 	int32_t head, tail, size;
+	struct tcb_s *rd_wait;			/* tasks blocked on a read */
+	struct tcb_s *wr_wait;			/* tasks blocked on a write */
+	uint16_t low, high;			/* watermarks */
+	uint16_t rd_level, wr_level;		/* wakeup levels of blocked tasks */
 };
 
 struct pipe_s *ucx_pipe_create(uint16_t size);
 int32_t ucx_pipe_destroy(struct pipe_s *pipe);
+int32_t ucx_pipe_watermark(struct pipe_s *pipe, uint16_t low, uint16_t high);
 void ucx_pipe_flush(struct pipe_s *pipe);
 int32_t ucx_pipe_size(struct pipe_s *pipe);
 int32_t ucx_pipe_get(struct pipe_s *pipe);
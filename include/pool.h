@@ -0,0 +1,43 @@
+/* kernel object pools: UCX_POOL_SIZE blocks taken from the heap (in one
+ * chunk) when the first object of a type is created, and UCX_POOL_GROW
+ * blocks more each time a pool is empty. with UCX_POOL_FIXED pools don't
+ * grow, so creating an object never takes memory from the heap after the
+ * first one, and fails once the pool is exhausted. */
+#ifndef UCX_POOL_SIZE
+#define UCX_POOL_SIZE		16
+#endif
+#ifndef UCX_POOL_GROW
+#ifdef UCX_POOL_FIXED
+#define UCX_POOL_GROW		0
+#else
+#define UCX_POOL_GROW		UCX_POOL_SIZE
+#endif
+#endif
+
+#define pool_align(size)	(((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* static initializer of a pool with no blocks, which takes 'count' blocks
+ * from the heap on the first allocation and 'grow' blocks when it is empty */
+#define POOL_INIT(size, count, grow)	{0, 0, pool_align(size), 0, 0, (count), (grow), 0}
+
+/* storage size for a pool on a static buffer (ucx_pool_init()) */
+#define POOL_SIZE(size, count)	(pool_align(size) * (count))
+
+struct pool_s {
+	void *free;				/* free blocks (linked through the blocks) */
+	void *chunks;				/* storage from the heap (linked through the first word) */
+	uint16_t block_size;
+	uint16_t count;				/* blocks */
+	uint16_t used;				/* blocks in use */
+	uint16_t reserve;			/* blocks taken on the first allocation */
+	uint16_t grow;				/* blocks added when the pool is empty (0: fixed size) */
+	uint16_t created;			/* created with ucx_pool_create() */
+};
+
+int32_t ucx_pool_init(struct pool_s *pool, void *data, uint16_t block_size, uint16_t count);
+struct pool_s *ucx_pool_create(uint16_t block_size, uint16_t count);
+int32_t ucx_pool_destroy(struct pool_s *pool);
+int32_t ucx_pool_grow(struct pool_s *pool, uint16_t count);
+void *ucx_pool_alloc(struct pool_s *pool);
+void ucx_pool_free(struct pool_s *pool, void *block);
+int32_t ucx_pool_count(struct pool_s *pool);
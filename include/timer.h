@@ -0,0 +1,28 @@
+/* timer wheel size (buckets), must be a power of 2 */
+#ifndef UCX_TIMER_WHEEL
+#define UCX_TIMER_WHEEL		64
+#endif
+
+/* priority of the timer task, which runs timer callbacks */
+#ifndef UCX_TIMER_PRIO
+#define UCX_TIMER_PRIO		TASK_HIGH_PRIO
+#endif
+
+/* timer modes and states */
+enum {TIMER_ONESHOT, TIMER_AUTORELOAD};
+enum {TIMER_STOPPED, TIMER_ARMED, TIMER_PENDING};
+
+struct timer_s {
+	struct timer_s *next;			/* wheel bucket or pending list links (circular) */
+	struct timer_s *prev;
+	void (*callback)(void *arg);
+	void *arg;
+	uint32_t expire;			/* absolute, in ticks */
+	uint32_t period;			/* reload period, 0 on one-shot timers */
+	uint8_t state;
+};
+
+struct timer_s *ucx_timer_create(void (*callback)(void *arg), void *arg);
+int32_t ucx_timer_destroy(struct timer_s *timer);
+int32_t ucx_timer_start(struct timer_s *timer, uint32_t ticks, uint8_t mode);
+int32_t ucx_timer_stop(struct timer_s *timer);
@@ -0,0 +1,40 @@
+/* kernel trace buffer size (events), must be a power of 2. with 0, the
+ * trace is left out and no events are recorded */
+#ifndef UCX_TRACE_SIZE
+#define UCX_TRACE_SIZE		32
+#endif
+
+/* trace events */
+enum {TRACE_SWITCH, TRACE_MISS, TRACE_REPORT, TRACE_TICK};
+
+/* trace event record
+ * 
+ * TRACE_SWITCH: id is the next task, arg the previous task (low 16 bits)
+ * 	and the ticks it ran continuously (high 16 bits);
+ * TRACE_MISS: id is the task that missed a deadline;
+ * TRACE_REPORT: arg is the number of tasks that run (low 16 bits) and
+ * 	deadline misses (high 16 bits) in the last hyperperiod;
+ * TRACE_TICK: id is the task selected on a tick (SCHEDULER_DEBUG).
+ */
+struct trace_s {
+	uint32_t time;				/* ticks */
+	uint32_t arg;
+	uint16_t id;
+	uint16_t event;
+};
+
+#if UCX_TRACE_SIZE
+struct trace_buf_s {
+	struct trace_s ev[UCX_TRACE_SIZE];
+	volatile uint16_t head, tail;		/* free running */
+	volatile uint16_t lost;
+};
+
+void krnl_trace(uint16_t event, uint16_t id, uint32_t arg);
+#else
+#define krnl_trace(event, id, arg)
+#endif
+
+int32_t ucx_trace_read(struct trace_s *ev);
+uint16_t ucx_trace_lost();
+void ucx_trace_dump();
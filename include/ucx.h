@@ -1,10 +1,17 @@
 #include <hal.h>
 #include <libc.h>
 #include <dump.h>
+#include <pool.h>
 #include <list.h>
 #include <queue.h>
 #include <pipe.h>
+#include <mailbox.h>
 #include <semaphore.h>
+#include <mutex.h>
+#include <event.h>
+#include <timer.h>
+#include <console.h>
+#include <trace.h>
 #include <malloc.h>
 #include <stdarg.h>
 
@@ -15,45 +22,103 @@
 #define TASK_LOW_PRIO		((0x3f << 8) | 0x3f)		/* priority 32 .. 63 */
 #define TASK_IDLE_PRIO		((0x7f << 8) | 0x7f)		/* priority 64 .. 127 */
 
+/* ready queue levels, one for each task priority (level 0 is TASK_CRIT_PRIO) */
+#define TASK_PRIO_LEVELS	5
+
 /* task states */
 enum {TASK_STOPPED, TASK_READY, TASK_RUNNING, TASK_BLOCKED, TASK_SUSPENDED};
 
+/* periodic task scheduling policies */
+enum {RT_POLICY_EDF, RT_POLICY_RM, RT_POLICY_DM};
+
+/* per task CPU time (in _readcounter() cycles) and heap accounting */
+struct task_stats_s {
+	uint64_t cycles;			/* run time */
+	uint32_t switches;			/* times dispatched */
+	uint32_t preemptions;			/* times preempted while ready */
+	uint32_t max_slice;			/* longest continuous run */
+	uint32_t heap;				/* live heap allocations, in bytes */
+};
+
 /* task control block node */
 struct tcb_s {
 	struct tcb_s *tcb_next;
+	struct tcb_s *rq_next;			/* ready queue links (circular, per priority level) */
+	struct tcb_s *rq_prev;
+	struct tcb_s *delay_next;		/* delay queue link */
 	void (*task)(void);
 	jmp_buf context;
 	uint32_t *guard_addr;
 	uint16_t guard_sz;
 	uint16_t id;
-	uint16_t delay;
+	uint16_t delay;				/* ticks after the previous task on the delay queue */
 	uint16_t priority;
 	uint8_t state;
 	uint8_t is_periodic;
 	uint16_t period;
-	uint16_t remaining_period_ticks;
 	uint16_t capacity;
 	uint16_t remaining_capacity_ticks;
 	uint16_t deadline;
-	uint16_t remaining_deadline_ticks;
+	uint32_t release;			/* next job release (absolute, in ticks) */
+	uint32_t abs_deadline;			/* current job deadline (absolute, in ticks) */
+	uint16_t rel_idx;			/* position on the release queue */
+	uint16_t edf_idx;			/* position on the EDF ready queue */
+	struct tcb_s *server;			/* CBS server of an aperiodic task */
+	struct tcb_s *srv_rq;			/* served ready tasks (CBS servers only) */
+	uint8_t is_server;
 	uint8_t has_run_in_lcm;
 	uint16_t continuous_capacity_consumed;
+	uint16_t base_priority;			/* priority, without inheritance */
+	uint8_t inherits;			/* inh_key is in use (periodic tasks) */
+	uint32_t inh_key;			/* inherited EDF ready queue key */
+	struct mutex_s *mtx_held;		/* mutexes held, last locked first */
+	struct mutex_s *mtx_wait;		/* mutex the task is blocked on */
+	struct tcb_s *mtx_next;			/* mutex wait list link */
+	struct tcb_s *wait_next;		/* pipe / mailbox wait list link */
+#ifdef UCX_TASK_STATS
+	struct task_stats_s stats;
+#endif
+};
+
+/* periodic task queues (binary min-heaps) */
+struct rt_heap_s {
+	struct tcb_s **node;
+	uint16_t count;
 };
 
 /* kernel control block */
 struct kcb_s {
 	struct tcb_s *tcb_p;
 	struct tcb_s *tcb_first;
+	struct tcb_s **tcb_tab;			/* tasks and CBS servers, indexed by id */
+	uint16_t tcb_tab_size;
+	struct tcb_s *rq_head[TASK_PRIO_LEVELS];	/* ready queues, one per priority level */
+	uint8_t rq_bitmap;			/* ready queue bitmap, bit (7 - level) set if not empty */
+	uint8_t preemptive;
+	struct tcb_s *delay_list;		/* delay queue (delta list) */
 	volatile uint32_t ctx_switches;
+	uint32_t ticks;
+	struct rt_heap_s rel_heap;		/* periodic tasks, by next release */
+	struct rt_heap_s edf_heap;		/* periodic jobs, by absolute deadline (or fixed priority) */
+	uint8_t rt_policy;			/* periodic task scheduling policy */
+	struct tcb_s *cbs_first;		/* CBS servers */
+	uint16_t cbs_count;
 	uint16_t id;
 	uint16_t deadline_misses;
 	uint16_t periods_least_common_multiple;
 	uint16_t ticks_until_next_report;
+#ifdef UCX_TASK_STATS
+	uint32_t stats_stamp;			/* counter at the last scheduling point */
+	uint32_t stats_slice;			/* current task continuous run */
+#endif
 };
 
 /* kernel base API */
 int32_t ucx_task_add(void *task, uint16_t guard_size);
 int32_t ucx_task_add_periodic(void *task, uint16_t period, uint16_t capacity, uint16_t deadline, uint16_t guard_size);
+int32_t ucx_rt_policy(uint8_t policy);
+int32_t ucx_cbs_create(uint16_t budget, uint16_t period);
+int32_t ucx_task_cbs(uint16_t id, uint16_t server);
 void ucx_task_init();
 void ucx_task_yield();
 void ucx_task_delay(uint16_t ticks);
@@ -63,6 +128,20 @@ int32_t ucx_task_priority(uint16_t id, uint16_t priority);
 uint16_t ucx_task_id();
 void ucx_task_wfi();
 uint16_t ucx_task_count();
+#ifdef UCX_TASK_STATS
+int32_t ucx_task_stats(uint16_t id, struct task_stats_s *stats);
+#endif
 void ucx_critical_enter();
 void ucx_critical_leave();
 int32_t app_main();
+
+/* kernel internal API */
+void krnl_task_state(struct tcb_s *tcb, uint8_t state);
+void krnl_reschedule(void);
+int32_t krnl_task_before(struct tcb_s *a, struct tcb_s *b);
+void krnl_task_inherit(struct tcb_s *tcb, struct tcb_s *from);
+void krnl_task_disinherit(struct tcb_s *tcb);
+void krnl_mutex_priority(struct tcb_s *tcb);
+void krnl_timer_init(void);
+void krnl_timer_tick(uint32_t ticks);
+uint32_t krnl_timer_next(uint32_t limit);
@@ -0,0 +1,319 @@
+/* file:          console.c
+ * description:   buffered console
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+/* console output is copied to a ring buffer, which is drained by the UART
+ * transmit interrupt, so printing costs a copy instead of the time the
+ * characters take on the wire. tasks are the producers (they only move
+ * the head) and the HAL transmit interrupt handler is the consumer (it
+ * only moves the tail, with krnl_console_tx()). when the buffer is full,
+ * output is dropped (and counted) or the task blocks until the buffer is
+ * half empty. with interrupts disabled (before the scheduler starts, in
+ * critical sections or in interrupt handlers) the transmit interrupt
+ * can't run, so the buffer is drained by polling instead.
+ * 
+ * input works the other way around: the HAL receive interrupt handler
+ * stores characters on a second ring buffer (krnl_console_rx()), and a
+ * reader sleeps until there is something to read. characters received
+ * while the buffer is full are lost. */
+
+#ifdef UCX_CONSOLE
+
+#define CONSOLE_MASK		(UCX_CONSOLE_SIZE - 1)
+#define CONSOLE_RX_MASK		(UCX_CONSOLE_RX_SIZE - 1)
+#define CONSOLE_SPACE		0x01
+#define CONSOLE_DATA		0x02
+#define CONSOLE_EMPTY		0x04
+
+struct console_s {
+	char buf[UCX_CONSOLE_SIZE];
+	volatile uint16_t head, tail;		/* free running */
+	volatile uint8_t active;		/* the transmit interrupt is enabled */
+	volatile uint8_t waiting;		/* a task waits for space */
+	volatile uint8_t flushing;		/* a task waits for the buffer to empty */
+	uint8_t policy;
+	volatile uint32_t dropped;
+	char rx_buf[UCX_CONSOLE_RX_SIZE];
+	volatile uint16_t rx_head, rx_tail;	/* free running */
+	volatile uint8_t rx_waiting;		/* a task waits for data */
+	struct event_s *event;
+};
+
+static struct console_s console;
+
+void krnl_console_init(void)
+{
+	console.event = ucx_event_create();
+}
+
+/* next character to be sent, or -1 if the buffer is empty (the HAL then
+ * disables the transmit interrupt). must be called with interrupts
+ * disabled. */
+int32_t krnl_console_tx(void)
+{
+	char c;
+	
+	if (console.head == console.tail) {
+		console.active = 0;
+		
+		return -1;
+	}
+	
+	c = console.buf[console.tail++ & CONSOLE_MASK];
+	if (console.waiting && (uint16_t)(console.head - console.tail) <= UCX_CONSOLE_SIZE / 2) {
+		console.waiting = 0;
+		ucx_event_set_isr(console.event, CONSOLE_SPACE);
+	}
+	if (console.flushing && console.head == console.tail) {
+		console.flushing = 0;
+		ucx_event_set_isr(console.event, CONSOLE_EMPTY);
+	}
+	
+	return (uint8_t)c;
+}
+
+/* stores a received character. must be called with interrupts disabled. */
+void krnl_console_rx(char c)
+{
+	if ((uint16_t)(console.rx_head - console.rx_tail) >= UCX_CONSOLE_RX_SIZE)
+		return;
+	
+	console.rx_buf[console.rx_head++ & CONSOLE_RX_MASK] = c;
+	if (console.rx_waiting) {
+		console.rx_waiting = 0;
+		ucx_event_set_isr(console.event, CONSOLE_DATA);
+	}
+}
+
+/* copies as much as fits and starts the transmit interrupt. must be called
+ * with interrupts disabled. */
+static uint32_t console_put(char *buf, uint32_t size)
+{
+	uint16_t head = console.head;
+	uint32_t free, first;
+	
+	free = UCX_CONSOLE_SIZE - (uint16_t)(head - console.tail);
+	if (size > free)
+		size = free;
+	if (!size)
+		return 0;
+	
+	first = UCX_CONSOLE_SIZE - (head & CONSOLE_MASK);
+	if (first > size)
+		first = size;
+	memcpy(&console.buf[head & CONSOLE_MASK], buf, first);
+	memcpy(console.buf, buf + first, size - first);
+	console.head = head + size;
+	
+	if (!console.active) {
+		console.active = 1;
+		_console_tx_start();
+	}
+	
+	return size;
+}
+
+/* sends a character by polling, with interrupts disabled */
+static void console_poll(void)
+{
+	int32_t c;
+	
+	c = krnl_console_tx();
+	if (c >= 0)
+		_putchar(c);
+}
+
+/* returns the number of bytes written, which is less than size only if
+ * the buffer was full and the policy is CONSOLE_DROP */
+int32_t ucx_console_write(char *buf, uint32_t size)
+{
+	uint32_t done = 0;
+	int32_t status;
+	
+	for (;;) {
+		status = _di();
+		done += console_put(buf + done, size - done);
+		if (done == size)
+			break;
+		if (console.policy == CONSOLE_DROP) {
+			console.dropped += size - done;
+			break;
+		}
+		if (!status) {
+			console_poll();
+		} else if (console.event) {
+			/* the flag is set by the transmit interrupt, so it
+			 * isn't lost if space is freed before the wait */
+			console.event->flags &= ~CONSOLE_SPACE;
+			console.waiting = 1;
+			_ei(status);
+			ucx_event_wait(console.event, CONSOLE_SPACE, EVENT_ANY);
+			continue;
+		}
+		_ei(status);
+	}
+	_ei(status);
+	
+	return done;
+}
+
+int32_t ucx_console_putchar(char c)
+{
+	return ucx_console_write(&c, 1);
+}
+
+/* blocks until something is received, and returns up to size bytes */
+int32_t ucx_console_read(char *buf, uint32_t size)
+{
+	uint32_t done = 0;
+	int32_t status;
+	
+	if (!size)
+		return 0;
+	
+	for (;;) {
+		status = _di();
+		while (done < size && console.rx_head != console.rx_tail)
+			buf[done++] = console.rx_buf[console.rx_tail++ & CONSOLE_RX_MASK];
+		if (done)
+			break;
+		if (!status) {
+			buf[done++] = _getchar();
+			break;
+		}
+		if (console.event) {
+			console.event->flags &= ~CONSOLE_DATA;
+			console.rx_waiting = 1;
+			_ei(status);
+			ucx_event_wait(console.event, CONSOLE_DATA, EVENT_ANY);
+			continue;
+		}
+		_ei(status);
+	}
+	_ei(status);
+	
+	return done;
+}
+
+int32_t ucx_console_getchar(void)
+{
+	char c;
+	
+	ucx_console_read(&c, 1);
+	
+	return (uint8_t)c;
+}
+
+int32_t ucx_console_policy(uint8_t policy)
+{
+	if (policy != CONSOLE_BLOCK && policy != CONSOLE_DROP)
+		return -1;
+	
+	console.policy = policy;
+	
+	return 0;
+}
+
+/* waits until the buffer is empty. the task sleeps until the transmit
+ * interrupt sends the last character, or polls with interrupts disabled */
+void ucx_console_flush(void)
+{
+	int32_t status;
+	
+	for (;;) {
+		status = _di();
+		if (console.head == console.tail)
+			break;
+		if (status && console.event) {
+			console.event->flags &= ~CONSOLE_EMPTY;
+			console.flushing = 1;
+			_ei(status);
+			ucx_event_wait(console.event, CONSOLE_EMPTY, EVENT_ANY);
+			continue;
+		}
+		console_poll();
+		_ei(status);
+	}
+	_ei(status);
+}
+
+uint32_t ucx_console_dropped(void)
+{
+	return console.dropped;
+}
+
+#else
+
+/* without UCX_CONSOLE, input and output are polled and never dropped */
+
+void krnl_console_init(void)
+{
+}
+
+int32_t krnl_console_tx(void)
+{
+	return -1;
+}
+
+void krnl_console_rx(char c)
+{
+}
+
+int32_t ucx_console_write(char *buf, uint32_t size)
+{
+	uint32_t i;
+	
+	for (i = 0; i < size; i++)
+		_putchar(buf[i]);
+	
+	return size;
+}
+
+int32_t ucx_console_putchar(char c)
+{
+	_putchar(c);
+	
+	return 1;
+}
+
+int32_t ucx_console_read(char *buf, uint32_t size)
+{
+	uint32_t done = 0;
+	
+	if (!size)
+		return 0;
+	
+	buf[done++] = _getchar();
+	while (done < size && _kbhit())
+		buf[done++] = _getchar();
+	
+	return done;
+}
+
+int32_t ucx_console_getchar(void)
+{
+	return _getchar();
+}
+
+int32_t ucx_console_policy(uint8_t policy)
+{
+	if (policy != CONSOLE_BLOCK && policy != CONSOLE_DROP)
+		return -1;
+	
+	return 0;
+}
+
+void ucx_console_flush(void)
+{
+}
+
+uint32_t ucx_console_dropped(void)
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,157 @@
+/* file:          event.c
+ * description:   event flag groups
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+extern struct kcb_s *kcb_p;
+
+static struct pool_s event_pool = POOL_INIT(sizeof(struct event_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
+struct event_s *ucx_event_create(void)
+{
+	struct event_s *ev;
+	
+	ev = (struct event_s *)ucx_pool_alloc(&event_pool);
+	if (!ev)
+		return 0;
+	
+	ev->flags = 0;
+	ev->waiters = 0;
+	
+	return ev;
+}
+
+int32_t ucx_event_destroy(struct event_s *ev)
+{
+	if (ev->waiters)
+		return -1;
+	
+	ucx_pool_free(&event_pool, ev);
+	
+	return 0;
+}
+
+static int32_t event_match(uint32_t flags, uint32_t mask, uint8_t mode)
+{
+	if (mode & EVENT_ALL)
+		return (flags & mask) == mask;
+	
+	return (flags & mask) != 0;
+}
+
+/* wakes all waiters satisfied by the current flags, in a single pass.
+ * flags to be cleared on exit are cleared after the pass, so waiters on
+ * the same flags are all woken. must be called with interrupts disabled. */
+static int32_t event_wake(struct event_s *ev)
+{
+	struct event_wait_s **wait_pp = &ev->waiters;
+	struct event_wait_s *wait;
+	uint32_t clear = 0;
+	int32_t woken = 0;
+	
+	while ((wait = *wait_pp)) {
+		if (!event_match(ev->flags, wait->mask, wait->mode)) {
+			wait_pp = &wait->next;
+			continue;
+		}
+		*wait_pp = wait->next;
+		wait->flags = ev->flags;
+		if (wait->mode & EVENT_CLEAR)
+			clear |= wait->mask;
+		krnl_task_state(wait->tcb, TASK_READY);
+		woken++;
+	}
+	ev->flags &= ~clear;
+	
+	return woken;
+}
+
+/* blocks until any (EVENT_ANY) or all (EVENT_ALL) of the flags on the mask
+ * are set. returns the flags that satisfied the wait, before the flags
+ * waited for are cleared (EVENT_CLEAR). must be called inside a task. */
+uint32_t ucx_event_wait(struct event_s *ev, uint32_t mask, uint8_t mode)
+{
+	struct event_wait_s wait, **wait_pp;
+	uint32_t flags;
+	
+	ucx_critical_enter();
+	flags = ev->flags;
+	if (event_match(flags, mask, mode)) {
+		if (mode & EVENT_CLEAR)
+			ev->flags &= ~mask;
+		ucx_critical_leave();
+		
+		return flags;
+	}
+	
+	wait.tcb = kcb_p->tcb_p;
+	wait.mask = mask;
+	wait.mode = mode;
+	wait.next = 0;
+	for (wait_pp = &ev->waiters; *wait_pp; wait_pp = &(*wait_pp)->next);
+	*wait_pp = &wait;
+	krnl_task_state(kcb_p->tcb_p, TASK_BLOCKED);
+	ucx_critical_leave();
+	krnl_reschedule();
+	
+	return wait.flags;
+}
+
+/* sets flags and wakes satisfied waiters. returns the flags left set.
+ * ucx_event_set() must be called inside a task, and switches to a woken
+ * task if it should run first. ucx_event_set_isr() doesn't switch, and
+ * may be called from interrupt handlers (it restores the interrupt state
+ * it found). */
+uint32_t ucx_event_set(struct event_s *ev, uint32_t mask)
+{
+	uint32_t flags;
+	int32_t woken;
+	
+	ucx_critical_enter();
+	ev->flags |= mask;
+	woken = ev->waiters ? event_wake(ev) : 0;
+	flags = ev->flags;
+	ucx_critical_leave();
+	
+	if (woken)
+		krnl_reschedule();
+	
+	return flags;
+}
+
+uint32_t ucx_event_set_isr(struct event_s *ev, uint32_t mask)
+{
+	uint32_t flags;
+	int32_t status;
+	
+	status = _di();
+	ev->flags |= mask;
+	if (ev->waiters)
+		event_wake(ev);
+	flags = ev->flags;
+	_ei(status);
+	
+	return flags;
+}
+
+/* clearing flags never wakes a task. may be called from interrupt handlers */
+uint32_t ucx_event_clear(struct event_s *ev, uint32_t mask)
+{
+	uint32_t flags;
+	int32_t status;
+	
+	status = _di();
+	ev->flags &= ~mask;
+	flags = ev->flags;
+	_ei(status);
+	
+	return flags;
+}
+
+uint32_t ucx_event_get(struct event_s *ev)
+{
+	return ev->flags;
+}
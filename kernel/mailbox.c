@@ -0,0 +1,155 @@
+/* file:          mailbox.c
+ * description:   fixed size message mailbox implementation
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+/* a mailbox owns a pool of 'count' message blocks, allocated once. a
+ * sender takes a free block, fills it in place and posts it, a receiver
+ * takes posted messages in order and gives the block back when done. no
+ * data is copied and all operations are O(1). as there are only 'count'
+ * blocks, the ring of posted messages never overflows. */
+
+static struct pool_s mbox_pool = POOL_INIT(sizeof(struct mbox_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
+struct mbox_s *ucx_mbox_create(uint16_t msg_size, uint16_t count)
+{
+	struct mbox_s *mbox;
+	
+	if (!count)
+		return 0;
+	
+	mbox = (struct mbox_s *)ucx_pool_alloc(&mbox_pool);
+	
+	if (!mbox)
+		return 0;
+	
+	mbox->pool = ucx_pool_create(msg_size, count);
+	mbox->slots = (void **)malloc(count * sizeof(void *));
+	if (!mbox->pool || !mbox->slots) {
+		if (mbox->slots)
+			free(mbox->slots);
+		if (mbox->pool)
+			ucx_pool_destroy(mbox->pool);
+		ucx_pool_free(&mbox_pool, mbox);
+		return 0;
+	}
+	
+	mbox->count = count;
+	mbox->head = 0;
+	mbox->tail = 0;
+	mbox->posted = 0;
+	mbox->rx_wait = 0;
+	
+	return mbox;
+}
+
+int32_t ucx_mbox_destroy(struct mbox_s *mbox)
+{
+	if (mbox->rx_wait || mbox->pool->used)
+		return -1;
+	
+	free(mbox->slots);
+	ucx_pool_destroy(mbox->pool);
+	ucx_pool_free(&mbox_pool, mbox);
+	
+	return 0;
+}
+
+/* returns a free message block, or 0 if all blocks are in use. */
+void *ucx_mbox_alloc(struct mbox_s *mbox)
+{
+	return ucx_pool_alloc(mbox->pool);
+}
+
+void ucx_mbox_free(struct mbox_s *mbox, void *msg)
+{
+	ucx_pool_free(mbox->pool, msg);
+}
+
+/* posts a message (a block from ucx_mbox_alloc()). a blocked receiver
+ * is woken and may preempt the sender. */
+int32_t ucx_mbox_post(struct mbox_s *mbox, void *msg)
+{
+	struct tcb_s *tcb = 0;
+	
+	ucx_critical_enter();
+	if (mbox->posted == mbox->count) {
+		ucx_critical_leave();
+		
+		return -1;
+	}
+	mbox->slots[mbox->tail] = msg;
+	if (++mbox->tail == mbox->count)
+		mbox->tail = 0;
+	mbox->posted++;
+	if (mbox->rx_wait) {
+		tcb = mbox->rx_wait;
+		mbox->rx_wait = tcb->wait_next;
+		krnl_task_state(tcb, TASK_READY);
+	}
+	ucx_critical_leave();
+	
+	if (tcb)
+		krnl_reschedule();
+	
+	return 0;
+}
+
+static void *mbox_get(struct mbox_s *mbox)
+{
+	void *msg;
+	
+	msg = mbox->slots[mbox->head];
+	if (++mbox->head == mbox->count)
+		mbox->head = 0;
+	mbox->posted--;
+	
+	return msg;
+}
+
+/* this routine is blocking and must be called inside a task. receivers
+ * wait on a list linked through their TCBs, in FIFO order, and a woken
+ * receiver blocks again if the message was taken before it runs. */
+void *ucx_mbox_recv(struct mbox_s *mbox)
+{
+	extern struct kcb_s *kcb_p;
+	struct tcb_s **wait;
+	void *msg;
+	
+	for (;;) {
+		ucx_critical_enter();
+		if (mbox->posted) {
+			msg = mbox_get(mbox);
+			ucx_critical_leave();
+			
+			return msg;
+		}
+		for (wait = &mbox->rx_wait; *wait; wait = &(*wait)->wait_next);
+		kcb_p->tcb_p->wait_next = 0;
+		*wait = kcb_p->tcb_p;
+		krnl_task_state(kcb_p->tcb_p, TASK_BLOCKED);
+		ucx_critical_leave();
+		krnl_reschedule();
+	}
+}
+
+/* returns the next posted message, or 0 if there is none. */
+void *ucx_mbox_tryrecv(struct mbox_s *mbox)
+{
+	void *msg = 0;
+	
+	ucx_critical_enter();
+	if (mbox->posted)
+		msg = mbox_get(mbox);
+	ucx_critical_leave();
+	
+	return msg;
+}
+
+int32_t ucx_mbox_count(struct mbox_s *mbox)
+{
+	return mbox->posted;
+}
@@ -0,0 +1,241 @@
+/* file:          mutex.c
+ * description:   mutexes with priority inheritance
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+extern struct kcb_s *kcb_p;
+
+static struct pool_s mutex_pool = POOL_INIT(sizeof(struct mutex_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
+struct mutex_s *ucx_mutex_create(void)
+{
+	struct mutex_s *m;
+	
+	m = (struct mutex_s *)ucx_pool_alloc(&mutex_pool);
+	if (!m)
+		return 0;
+	
+	m->owner = 0;
+	m->waiters = 0;
+	m->next = 0;
+	m->count = 0;
+	
+	return m;
+}
+
+int32_t ucx_mutex_destroy(struct mutex_s *m)
+{
+	if (m->owner)
+		return -1;
+	
+	ucx_pool_free(&mutex_pool, m);
+	
+	return 0;
+}
+
+/* wait list, in order of urgency (FIFO for tasks of the same priority) */
+static void mutex_wait_insert(struct mutex_s *m, struct tcb_s *tcb)
+{
+	struct tcb_s **tcb_pp = &m->waiters;
+	
+	while (*tcb_pp && !krnl_task_before(tcb, *tcb_pp))
+		tcb_pp = &(*tcb_pp)->mtx_next;
+	tcb->mtx_next = *tcb_pp;
+	*tcb_pp = tcb;
+}
+
+static void mutex_wait_remove(struct mutex_s *m, struct tcb_s *tcb)
+{
+	struct tcb_s **tcb_pp = &m->waiters;
+	
+	while (*tcb_pp != tcb)
+		tcb_pp = &(*tcb_pp)->mtx_next;
+	*tcb_pp = tcb->mtx_next;
+}
+
+static void mutex_held_push(struct mutex_s *m, struct tcb_s *tcb)
+{
+	m->owner = tcb;
+	m->count = 1;
+	m->next = tcb->mtx_held;
+	tcb->mtx_held = m;
+}
+
+static void mutex_held_remove(struct mutex_s *m, struct tcb_s *tcb)
+{
+	struct mutex_s **m_pp = &tcb->mtx_held;
+	
+	while (*m_pp != m)
+		m_pp = &(*m_pp)->next;
+	*m_pp = m->next;
+}
+
+/* the owner of a mutex inherits the parameters of a new waiter. if the
+ * owner is itself blocked on a mutex, the owner of that mutex does too,
+ * and so on, along the chain of blocked tasks. */
+static void mutex_inherit(struct mutex_s *m, struct tcb_s *tcb)
+{
+	struct tcb_s *owner;
+	
+	for (; m; m = owner->mtx_wait) {
+		owner = m->owner;
+		krnl_task_inherit(owner, tcb);
+		if (owner->mtx_wait) {
+			mutex_wait_remove(owner->mtx_wait, owner);
+			mutex_wait_insert(owner->mtx_wait, owner);
+		}
+	}
+}
+
+/* a task runs with its own parameters, or with the ones inherited from
+ * waiters of the mutexes it holds */
+static void mutex_update(struct tcb_s *tcb)
+{
+	struct mutex_s *m;
+	
+	krnl_task_disinherit(tcb);
+	for (m = tcb->mtx_held; m; m = m->next)
+		if (m->waiters)
+			krnl_task_inherit(tcb, m->waiters);
+}
+
+/* after a release, inherited parameters can only be lowered */
+static void mutex_restore(struct tcb_s *tcb)
+{
+	if (!tcb->inherits && tcb->priority == tcb->base_priority)
+		return;
+	
+	mutex_update(tcb);
+}
+
+/* called by ucx_task_priority() in a critical section, after the base
+ * priority of a task is changed. the task is moved on the wait list of the
+ * mutex it is blocked on, and the owner of that mutex inherits from its
+ * waiters again, and so on, along the chain of blocked tasks. */
+void krnl_mutex_priority(struct tcb_s *tcb)
+{
+	struct mutex_s *m;
+	
+	for (;;) {
+		mutex_update(tcb);
+		m = tcb->mtx_wait;
+		if (!m)
+			break;
+		mutex_wait_remove(m, tcb);
+		mutex_wait_insert(m, tcb);
+		tcb = m->owner;
+	}
+}
+
+/* a task blocked on m would wait for itself */
+static int32_t mutex_deadlock(struct mutex_s *m, struct tcb_s *tcb)
+{
+	for (; m; m = m->owner->mtx_wait)
+		if (m->owner == tcb)
+			return 1;
+	
+	return 0;
+}
+
+int32_t ucx_mutex_trylock(struct mutex_s *m)
+{
+	struct tcb_s *tcb;
+	
+	ucx_critical_enter();
+	tcb = kcb_p->tcb_p;
+	if (!m->owner) {
+		mutex_held_push(m, tcb);
+	} else if (m->owner == tcb && m->count < 0xffff) {
+		m->count++;
+	} else {
+		ucx_critical_leave();
+		
+		return -1;
+	}
+	ucx_critical_leave();
+	
+	return 0;
+}
+
+/* a waiter blocks until ucx_mutex_unlock() hands the mutex over to it,
+ * so it owns the mutex when it runs again. returns -1 on a deadlock. */
+int32_t ucx_mutex_lock(struct mutex_s *m)
+{
+	struct tcb_s *tcb;
+	
+	ucx_critical_enter();
+	tcb = kcb_p->tcb_p;
+	if (!m->owner) {
+		mutex_held_push(m, tcb);
+		ucx_critical_leave();
+		
+		return 0;
+	}
+	if (m->owner == tcb) {
+		if (m->count == 0xffff) {
+			ucx_critical_leave();
+			
+			return -1;
+		}
+		m->count++;
+		ucx_critical_leave();
+		
+		return 0;
+	}
+	if (mutex_deadlock(m, tcb)) {
+		ucx_critical_leave();
+		
+		return -1;
+	}
+	
+	tcb->mtx_wait = m;
+	mutex_wait_insert(m, tcb);
+	mutex_inherit(m, tcb);
+	krnl_task_state(tcb, TASK_BLOCKED);
+	ucx_critical_leave();
+	krnl_reschedule();
+	
+	return 0;
+}
+
+int32_t ucx_mutex_unlock(struct mutex_s *m)
+{
+	struct tcb_s *tcb, *next;
+	
+	ucx_critical_enter();
+	tcb = kcb_p->tcb_p;
+	if (m->owner != tcb) {
+		ucx_critical_leave();
+		
+		return -1;
+	}
+	if (--m->count) {
+		ucx_critical_leave();
+		
+		return 0;
+	}
+	
+	mutex_held_remove(m, tcb);
+	next = m->waiters;
+	if (next) {
+		/* hand over to the most urgent waiter */
+		m->waiters = next->mtx_next;
+		next->mtx_wait = 0;
+		mutex_held_push(m, next);
+		if (m->waiters)
+			krnl_task_inherit(next, m->waiters);
+		krnl_task_state(next, TASK_READY);
+	} else {
+		m->owner = 0;
+	}
+	mutex_restore(tcb);
+	ucx_critical_leave();
+	
+	if (next)
+		krnl_reschedule();
+	
+	return 0;
+}
@@ -6,6 +6,8 @@
 
 #include <ucx.h>
 
+static struct pool_s pipe_pool = POOL_INIT(sizeof(struct pipe_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
 static int32_t ispowerof2(uint32_t x)
 {
 	return x && !(x & (x - 1));
@@ -24,6 +26,94 @@ static uint32_t nextpowerof2(uint32_t x)
 	return x;
 }
 
+/* pipe wait lists
+ * 
+ * tasks blocked on a read wait on the reader list until the pipe holds
+ * enough data, tasks blocked on a write wait on the writer list until
+ * enough space is free. the lists are linked through the TCBs, in FIFO
+ * order, so blocking never fails. the wakeup level is the smallest amount
+ * a blocked task can make progress with, limited by the watermarks:
+ * readers need at least 'high' bytes (or what is left of their request),
+ * writers need the pipe level to drop to 'low' bytes (or space for what
+ * is left of their request). all waiters are woken at once and retry.
+ * must be called with interrupts disabled.
+ */
+
+static void pipe_block(struct tcb_s **wait, uint16_t *level, uint16_t need)
+{
+	extern struct kcb_s *kcb_p;
+	struct tcb_s *tcb = kcb_p->tcb_p;
+	
+	if (!*wait || need < *level)
+		*level = need;
+	
+	while (*wait)
+		wait = &(*wait)->wait_next;
+	tcb->wait_next = 0;
+	*wait = tcb;
+	krnl_task_state(tcb, TASK_BLOCKED);
+}
+
+static int32_t pipe_wake(struct tcb_s **wait, uint16_t *level, uint16_t avail)
+{
+	struct tcb_s *tcb;
+	int32_t woken = 0;
+	
+	if (!*wait || avail < *level)
+		return 0;
+	
+	while ((tcb = *wait)) {
+		*wait = tcb->wait_next;
+		krnl_task_state(tcb, TASK_READY);
+		woken++;
+	}
+	
+	return woken;
+}
+
+/* data is moved in (at most) two contiguous spans of the ring */
+static uint16_t pipe_copy_out(struct pipe_s *pipe, char *data, uint16_t size)
+{
+	uint16_t span;
+	
+	if (size > pipe->size)
+		size = pipe->size;
+	
+	span = min(size, pipe->mask + 1 - pipe->head);
+	memcpy(data, pipe->data + pipe->head, span);
+	memcpy(data + span, pipe->data, size - span);
+	pipe->head = (pipe->head + size) & pipe->mask;
+	pipe->size -= size;
+	
+	return size;
+}
+
+static uint16_t pipe_copy_in(struct pipe_s *pipe, char *data, uint16_t size)
+{
+	uint16_t span;
+	
+	if (size > pipe->mask - pipe->size)
+		size = pipe->mask - pipe->size;
+	
+	span = min(size, pipe->mask + 1 - pipe->tail);
+	memcpy(pipe->data + pipe->tail, data, span);
+	memcpy(pipe->data, data + span, size - span);
+	pipe->tail = (pipe->tail + size) & pipe->mask;
+	pipe->size += size;
+	
+	return size;
+}
+
+static int32_t pipe_wake_readers(struct pipe_s *pipe)
+{
+	return pipe_wake(&pipe->rd_wait, &pipe->rd_level, pipe->size);
+}
+
+static int32_t pipe_wake_writers(struct pipe_s *pipe)
+{
+	return pipe_wake(&pipe->wr_wait, &pipe->wr_level, pipe->mask - pipe->size);
+}
+
 struct pipe_s *ucx_pipe_create(uint16_t size)
 {
 	struct pipe_s *pipe;
@@ -34,7 +124,7 @@ struct pipe_s *ucx_pipe_create(uint16_t size)
 	if (!ispowerof2(size))
 		size = nextpowerof2(size);
 		
-	pipe = (struct pipe_s *)malloc(sizeof(struct pipe_s));
+	pipe = (struct pipe_s *)ucx_pool_alloc(&pipe_pool);
 	
 	if (!pipe)
 		return 0;
@@ -42,12 +132,16 @@ struct pipe_s *ucx_pipe_create(uint16_t size)
 	pipe->mask = size - 1;
 	pipe->data = (char *)malloc(size);
 	if (!pipe->data) {
-		free(pipe);
+		ucx_pool_free(&pipe_pool, pipe);
 		return 0;
 	}
+	pipe->rd_wait = 0;
+	pipe->wr_wait = 0;
 	pipe->head = 0;
 	pipe->tail = 0;
 	pipe->size = 0;
+	pipe->low = size - 2;
+	pipe->high = 1;
 	
 	return pipe;
 }
@@ -57,20 +151,44 @@ int32_t ucx_pipe_destroy(struct pipe_s *pipe)
 	if (!pipe->data)
 		return -1;
 	
+	if (pipe->rd_wait || pipe->wr_wait)
+		return -1;
+	
 	pipe->mask = 0;
 	free(pipe->data);
-	free(pipe);
+	ucx_pool_free(&pipe_pool, pipe);
+	
+	return 0;
+}
+
+/* blocked readers are woken when the pipe holds at least 'high' bytes,
+ * blocked writers when it holds 'low' bytes or less. */
+int32_t ucx_pipe_watermark(struct pipe_s *pipe, uint16_t low, uint16_t high)
+{
+	if (high < 1 || high > pipe->mask || low >= pipe->mask)
+		return -1;
+	
+	ucx_critical_enter();
+	pipe->low = low;
+	pipe->high = high;
+	ucx_critical_leave();
 	
 	return 0;
 }
 
 void ucx_pipe_flush(struct pipe_s *pipe)
 {
+	int32_t woken;
+	
 	ucx_critical_enter();
 	pipe->head = 0;
 	pipe->tail = 0;
 	pipe->size = 0;
+	woken = pipe_wake_writers(pipe);
 	ucx_critical_leave();
+	
+	if (woken)
+		krnl_reschedule();
 }
 
 int32_t ucx_pipe_size(struct pipe_s *pipe)
@@ -78,6 +196,9 @@ int32_t ucx_pipe_size(struct pipe_s *pipe)
 	return pipe->size;
 }
 
+/* non blocking, single byte access. blocked tasks are made ready, but
+ * no context switch happens here (these may be called from interrupt
+ * handlers). */
 int32_t ucx_pipe_get(struct pipe_s *pipe)
 {
 	int32_t head, data;
@@ -90,6 +211,7 @@ int32_t ucx_pipe_get(struct pipe_s *pipe)
 	pipe->head = (pipe->head + 1) & pipe->mask;
 	data = pipe->data[head];
 	pipe->size--;
+	pipe_wake_writers(pipe);
 	ucx_critical_leave();
 
 	return data;
@@ -107,44 +229,55 @@ int32_t ucx_pipe_put(struct pipe_s *pipe, char data)
 	pipe->data[pipe->tail] = data;
 	pipe->tail = tail;
 	pipe->size++;
+	pipe_wake_readers(pipe);
 	ucx_critical_leave();
 
 	return 0;
 }
 
-/* this routine is blocking and must be called inside a task. */
+/* this routine is blocking and must be called inside a task. it returns
+ * when all data is read. */
 int32_t ucx_pipe_read(struct pipe_s *pipe, char *data, uint16_t size)
 {
 	uint16_t i = 0;
-	int32_t byte;
+	int32_t woken;
 	
-	while (i < size) {
-		byte = ucx_pipe_get(pipe);
-
-		if (byte == -1)
-			continue;
-
-		data[i] = byte;
-		i++;
+	for (;;) {
+		ucx_critical_enter();
+		i += pipe_copy_out(pipe, data + i, size - i);
+		woken = pipe_wake_writers(pipe);
+		if (i < size)
+			pipe_block(&pipe->rd_wait, &pipe->rd_level, min(size - i, pipe->high));
+		ucx_critical_leave();
+		
+		if (woken || i < size)
+			krnl_reschedule();
+		if (i == size)
+			break;
 	}
 	
 	return i;
-	
 }
 
-/* this routine is blocking and must be called inside a task. */
+/* this routine is blocking and must be called inside a task. it returns
+ * when all data is written. */
 int32_t ucx_pipe_write(struct pipe_s *pipe, char *data, uint16_t size)
 {
 	uint16_t i = 0;
-	int32_t res;
+	int32_t woken;
 	
-	while (i < size) {
-		res = ucx_pipe_put(pipe, data[i]);
-
-		if (res == -1)
-			continue;
-
-		i++;
+	for (;;) {
+		ucx_critical_enter();
+		i += pipe_copy_in(pipe, data + i, size - i);
+		woken = pipe_wake_readers(pipe);
+		if (i < size)
+			pipe_block(&pipe->wr_wait, &pipe->wr_level, min(size - i, pipe->mask - pipe->low));
+		ucx_critical_leave();
+		
+		if (woken || i < size)
+			krnl_reschedule();
+		if (i == size)
+			break;
 	}
 
 	return i;
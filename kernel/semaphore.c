@@ -6,11 +6,13 @@
 
 #include <ucx.h>
 
+static struct pool_s sem_pool = POOL_INIT(sizeof(struct sem_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
 struct sem_s *ucx_semcreate(int32_t value)
 {
 	struct sem_s *s;
 	
-	s = (struct sem_s *)malloc(sizeof(struct sem_s));
+	s = (struct sem_s *)ucx_pool_alloc(&sem_pool);
 	
 	if (!s)
 		return 0;
@@ -18,7 +20,7 @@ struct sem_s *ucx_semcreate(int32_t value)
 	s->sem_queue = ucx_queue_create(ucx_task_count());
 	
 	if ((!s->sem_queue) || (value < 0)) {
-		free(s);
+		ucx_pool_free(&sem_pool, s);
 		
 		return 0;
 	} else {
@@ -34,12 +36,14 @@ int32_t ucx_semdestroy(struct sem_s *s)
 	if (ucx_queue_destroy(s->sem_queue)) {
 		return -1;
 	} else {
-		free(s);
+		ucx_pool_free(&sem_pool, s);
 		
 		return 0;
 	}
 }
 
+/* a waiter blocks until ucx_signal() hands the semaphore over to it: the
+ * count is not incremented and the waiter returns without taking it again. */
 void ucx_wait(struct sem_s *s)
 {
 	extern struct kcb_s *kcb_p;
@@ -48,9 +52,9 @@ void ucx_wait(struct sem_s *s)
 	s->count--;
 	if (s->count < 0) {
 		ucx_queue_enqueue(s->sem_queue, kcb_p->tcb_p);
-		kcb_p->tcb_p->state = TASK_BLOCKED;
+		krnl_task_state(kcb_p->tcb_p, TASK_BLOCKED);
 		ucx_critical_leave();
-		ucx_task_wfi();
+		krnl_reschedule();
 	} else {
 		ucx_critical_leave();
 	}
@@ -58,13 +62,16 @@ void ucx_wait(struct sem_s *s)
 
 void ucx_signal(struct sem_s *s)
 {
-	struct tcb_s *tcb_sem; 
+	struct tcb_s *tcb_sem = 0;
 	
 	ucx_critical_enter();
 	s->count++;
 	if (s->count <= 0) {
 		tcb_sem = ucx_queue_dequeue(s->sem_queue);
-		tcb_sem->state = TASK_READY;
+		krnl_task_state(tcb_sem, TASK_READY);
 	}
 	ucx_critical_leave();
+	
+	if (tcb_sem)
+		krnl_reschedule();
 }
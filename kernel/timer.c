@@ -0,0 +1,268 @@
+/* file:          timer.c
+ * description:   software timers
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+extern struct kcb_s *kcb_p;
+
+/* software timers
+ * 
+ * armed timers are kept on a hashed timer wheel: the bucket of a timer is
+ * its expiration tick modulo the wheel size, and buckets are unsorted
+ * circular lists. on every tick, only the bucket of the current tick is
+ * visited, so the cost of a tick depends on the number of timers on that
+ * bucket, not on the total number of timers. expired timers are moved to
+ * a pending list, and their callbacks are run by the timer task, which
+ * is always added by the kernel after app_main() (tasks can't be added
+ * once the scheduler runs, so it can't wait for the first timer).
+ */
+
+static struct pool_s timer_pool = POOL_INIT(sizeof(struct timer_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+static struct timer_s *timer_wheel[UCX_TIMER_WHEEL];
+static struct timer_s *timer_pending;
+static struct tcb_s *timer_task;
+static uint32_t timer_now;
+static uint16_t timer_armed;
+static uint8_t timer_started;
+
+#define TIMER_MASK		(UCX_TIMER_WHEEL - 1)
+#define time_before(a, b)	((int32_t)((a) - (b)) < 0)
+
+static void timer_list_insert(struct timer_s **head, struct timer_s *timer)
+{
+	if (*head) {
+		timer->next = *head;
+		timer->prev = (*head)->prev;
+		(*head)->prev->next = timer;
+		(*head)->prev = timer;
+	} else {
+		timer->next = timer;
+		timer->prev = timer;
+		*head = timer;
+	}
+}
+
+static void timer_list_remove(struct timer_s **head, struct timer_s *timer)
+{
+	if (timer->next == timer) {
+		*head = 0;
+		
+		return;
+	}
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	if (*head == timer)
+		*head = timer->next;
+}
+
+static void timer_arm(struct timer_s *timer, uint32_t expire)
+{
+	timer->expire = expire;
+	timer->state = TIMER_ARMED;
+	timer_list_insert(&timer_wheel[expire & TIMER_MASK], timer);
+	timer_armed++;
+}
+
+static void timer_disarm(struct timer_s *timer)
+{
+	if (timer->state == TIMER_ARMED) {
+		timer_list_remove(&timer_wheel[timer->expire & TIMER_MASK], timer);
+		timer_armed--;
+	} else if (timer->state == TIMER_PENDING) {
+		timer_list_remove(&timer_pending, timer);
+	}
+	timer->state = TIMER_STOPPED;
+}
+
+/* moves expired timers on a bucket to the pending list */
+static void timer_expire(struct timer_s **bucket)
+{
+	struct timer_s *timer, *next;
+	uint16_t n;
+	
+	if (!*bucket)
+		return;
+	
+	/* the list is changed while walking it, count the timers first */
+	timer = *bucket;
+	for (n = 1; timer->next != *bucket; n++)
+		timer = timer->next;
+	
+	for (timer = *bucket; n; n--, timer = next) {
+		next = timer->next;
+		if (time_before(timer_now, timer->expire))
+			continue;
+		timer_list_remove(bucket, timer);
+		timer_armed--;
+		timer->state = TIMER_PENDING;
+		timer_list_insert(&timer_pending, timer);
+	}
+}
+
+/* called by the dispatcher with the number of ticks elapsed (more than one
+ * on tickless idle). each bucket is visited at most once. */
+void krnl_timer_tick(uint32_t ticks)
+{
+	uint32_t i, n;
+	
+	timer_now += ticks;
+	if (!timer_armed)
+		return;
+	
+	n = ticks < UCX_TIMER_WHEEL ? ticks : UCX_TIMER_WHEEL;
+	for (i = 0; i < n; i++)
+		timer_expire(&timer_wheel[(timer_now - i) & TIMER_MASK]);
+	
+	if (timer_pending && timer_task && timer_task->state == TASK_BLOCKED)
+		krnl_task_state(timer_task, TASK_READY);
+}
+
+/* ticks until the next expiration, up to limit (tickless idle). buckets
+ * are visited in expiration order, so the walk stops at the first timer
+ * of the current round of the wheel. */
+uint32_t krnl_timer_next(uint32_t limit)
+{
+	struct timer_s *timer;
+	uint32_t d, delta;
+	
+	if (!timer_armed)
+		return limit;
+	
+	for (d = 1; d <= UCX_TIMER_WHEEL && d < limit; d++) {
+		timer = timer_wheel[(timer_now + d) & TIMER_MASK];
+		if (!timer)
+			continue;
+		do {
+			delta = timer->expire - timer_now;
+			if (delta < limit)
+				limit = delta;
+			timer = timer->next;
+		} while (timer != timer_wheel[(timer_now + d) & TIMER_MASK]);
+	}
+	
+	return limit;
+}
+
+/* runs callbacks of expired timers, and reloads auto-reload timers. a
+ * late reload skips the periods already gone, so there is no drift. */
+static void timer_daemon(void)
+{
+	struct timer_s *timer;
+	void (*callback)(void *arg);
+	void *arg;
+	uint32_t expire;
+	
+	ucx_task_init();
+	
+	for (;;) {
+		ucx_critical_enter();
+		timer = timer_pending;
+		if (!timer) {
+			krnl_task_state(kcb_p->tcb_p, TASK_BLOCKED);
+			ucx_critical_leave();
+			krnl_reschedule();
+			continue;
+		}
+		
+		timer_list_remove(&timer_pending, timer);
+		timer->state = TIMER_STOPPED;
+		callback = timer->callback;
+		arg = timer->arg;
+		if (timer->period) {
+			expire = timer->expire + timer->period;
+			while (!time_before(timer_now, expire))
+				expire += timer->period;
+			timer_arm(timer, expire);
+		}
+		ucx_critical_leave();
+		
+		callback(arg);
+	}
+}
+
+/* called from main(), after app_main(). the timer task is blocked until
+ * a timer expires. if it can't be added (no memory), timers would never
+ * run: they are stopped, and can't be started again. */
+void krnl_timer_init(void)
+{
+	uint32_t i;
+	
+	timer_started = 1;
+	if (ucx_task_add(timer_daemon, DEFAULT_GUARD_SIZE)) {
+		for (i = 0; i < UCX_TIMER_WHEEL; i++)
+			while (timer_wheel[i])
+				timer_disarm(timer_wheel[i]);
+		
+		return;
+	}
+	timer_task = kcb_p->tcb_p;
+	ucx_task_priority(timer_task->id, UCX_TIMER_PRIO);
+}
+
+/* timers can be created in app_main() or by tasks. creating and starting
+ * timers only fails at run time if the timer task couldn't be added. */
+struct timer_s *ucx_timer_create(void (*callback)(void *arg), void *arg)
+{
+	struct timer_s *timer;
+	
+	if (!callback || (timer_started && !timer_task))
+		return 0;
+	
+	timer = (struct timer_s *)ucx_pool_alloc(&timer_pool);
+	if (!timer)
+		return 0;
+	
+	timer->callback = callback;
+	timer->arg = arg;
+	timer->period = 0;
+	timer->state = TIMER_STOPPED;
+	
+	return timer;
+}
+
+int32_t ucx_timer_destroy(struct timer_s *timer)
+{
+	ucx_critical_enter();
+	timer_disarm(timer);
+	ucx_critical_leave();
+	
+	ucx_pool_free(&timer_pool, timer);
+	
+	return 0;
+}
+
+/* (re)starts a timer, which expires in a number of ticks. auto-reload
+ * timers expire again every number of ticks. */
+int32_t ucx_timer_start(struct timer_s *timer, uint32_t ticks, uint8_t mode)
+{
+	if (!ticks || ticks >= 0x80000000 || mode > TIMER_AUTORELOAD)
+		return -1;
+	if (timer_started && !timer_task)
+		return -1;
+	
+	ucx_critical_enter();
+	timer_disarm(timer);
+	timer->period = mode == TIMER_AUTORELOAD ? ticks : 0;
+	timer_arm(timer, timer_now + ticks);
+	ucx_critical_leave();
+	
+	return 0;
+}
+
+/* a stopped timer doesn't run its callback, even if it has expired */
+int32_t ucx_timer_stop(struct timer_s *timer)
+{
+	ucx_critical_enter();
+	if (timer->state == TIMER_STOPPED) {
+		ucx_critical_leave();
+		
+		return -1;
+	}
+	timer_disarm(timer);
+	ucx_critical_leave();
+	
+	return 0;
+}
@@ -0,0 +1,100 @@
+/* file:          trace.c
+ * description:   kernel event trace
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+/* scheduler events are recorded on a ring buffer, instead of printed from
+ * the timer interrupt. the kernel is the only producer (it writes with
+ * interrupts disabled and only moves the head) and a task is the only
+ * consumer (it only moves the tail), so no locking is needed. events are
+ * dropped (and counted) when the buffer is full. */
+
+#if UCX_TRACE_SIZE
+
+extern struct kcb_s *kcb_p;
+
+static struct trace_buf_s trace_buf;
+
+void krnl_trace(uint16_t event, uint16_t id, uint32_t arg)
+{
+	struct trace_s *ev;
+	uint16_t head = trace_buf.head;
+	
+	if ((uint16_t)(head - trace_buf.tail) >= UCX_TRACE_SIZE) {
+		trace_buf.lost++;
+		return;
+	}
+	
+	ev = &trace_buf.ev[head & (UCX_TRACE_SIZE - 1)];
+	ev->time = kcb_p->ticks;
+	ev->event = event;
+	ev->id = id;
+	ev->arg = arg;
+	trace_buf.head = head + 1;
+}
+
+int32_t ucx_trace_read(struct trace_s *ev)
+{
+	uint16_t tail = trace_buf.tail;
+	
+	if (tail == trace_buf.head)
+		return -1;
+	
+	*ev = trace_buf.ev[tail & (UCX_TRACE_SIZE - 1)];
+	trace_buf.tail = tail + 1;
+	
+	return 0;
+}
+
+uint16_t ucx_trace_lost()
+{
+	return trace_buf.lost;
+}
+
+/* decodes pending events to the console */
+void ucx_trace_dump()
+{
+	struct trace_s ev;
+	
+	while (!ucx_trace_read(&ev)) {
+		switch (ev.event) {
+		case TRACE_SWITCH:
+			printf("%d: task %d ran %d, running task %d\n", ev.time,
+				ev.arg & 0xffff, ev.arg >> 16, ev.id);
+			break;
+		case TRACE_MISS:
+			printf("%d: dm:%d\n", ev.time, ev.id);
+			break;
+		case TRACE_REPORT:
+			printf("%d: deadline misses: %d, jobs run: %d\n", ev.time,
+				ev.arg >> 16, ev.arg & 0xffff);
+			break;
+		case TRACE_TICK:
+			printf("%d: %d\n", ev.time, ev.id);
+			break;
+		}
+	}
+}
+
+#else
+
+/* without a trace buffer, there is nothing to read */
+
+int32_t ucx_trace_read(struct trace_s *ev)
+{
+	return -1;
+}
+
+uint16_t ucx_trace_lost()
+{
+	return 0;
+}
+
+void ucx_trace_dump()
+{
+}
+
+#endif
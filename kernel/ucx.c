@@ -10,9 +10,50 @@ struct kcb_s kernel_state;
 struct kcb_s *kcb_p = &kernel_state;
 uint16_t task_count = 0;
 uint32_t dispatch_count = 0;
+static struct pool_s tcb_pool = POOL_INIT(sizeof(struct tcb_s), UCX_POOL_SIZE, UCX_POOL_GROW);
 
 /* kernel auxiliary functions */
 
+/* id to TCB table. ids are never reused, so the table only grows (in steps
+ * of UCX_POOL_SIZE entries) and a lookup is a bounds check and an index */
+static int32_t krnl_tcb_register(struct tcb_s *tcb)
+{
+	struct tcb_s **tab;
+	uint16_t size;
+	
+	if (kcb_p->id >= kcb_p->tcb_tab_size) {
+		size = kcb_p->tcb_tab_size + UCX_POOL_SIZE;
+		tab = (struct tcb_s **)realloc(kcb_p->tcb_tab, size * sizeof(struct tcb_s *));
+		if (!tab)
+			return -1;
+		kcb_p->tcb_tab = tab;
+		kcb_p->tcb_tab_size = size;
+	}
+	tcb->id = kcb_p->id++;
+	kcb_p->tcb_tab[tcb->id] = tcb;
+	
+	return 0;
+}
+
+static struct tcb_s *krnl_tcb(uint16_t id)
+{
+	if (id >= kcb_p->id)
+		return 0;
+	
+	return kcb_p->tcb_tab[id];
+}
+
+/* tasks only, CBS servers can't be suspended, resumed or changed */
+static struct tcb_s *krnl_task(uint16_t id)
+{
+	struct tcb_s *tcb = krnl_tcb(id);
+	
+	if (!tcb || tcb->is_server)
+		return 0;
+	
+	return tcb;
+}
+
 static void krnl_guard_check(void)
 {
 	uint32_t check = 0x33333333;
@@ -26,23 +67,49 @@ static void krnl_guard_check(void)
 		
 }
 
-static void krnl_delay_update(void)
+/* delayed tasks are kept in a delta list, sorted by wakeup time (and by
+ * id for the same wakeup time, so tasks are readied in task list order).
+ * each entry holds the number of ticks after its predecessor, so an
+ * update only touches the head of the list. */
+static void krnl_delay_insert(struct tcb_s *tcb, uint16_t ticks)
 {
-	struct tcb_s *tcb_ptr = kcb_p->tcb_first;
+	struct tcb_s **tcb_pp = &kcb_p->delay_list;
 	
-	for (;;	tcb_ptr = tcb_ptr->tcb_next) {
-		if (tcb_ptr->state == TASK_BLOCKED && tcb_ptr->delay > 0) {
-			tcb_ptr->delay--;
-			if (tcb_ptr->delay == 0)
-				tcb_ptr->state = TASK_READY;
-		}
-		if (tcb_ptr->tcb_next == kcb_p->tcb_first) break;
+	while (*tcb_pp && ((*tcb_pp)->delay < ticks ||
+	    ((*tcb_pp)->delay == ticks && (*tcb_pp)->id < tcb->id))) {
+		ticks -= (*tcb_pp)->delay;
+		tcb_pp = &(*tcb_pp)->delay_next;
 	}
+	tcb->delay = ticks;
+	tcb->delay_next = *tcb_pp;
+	if (*tcb_pp)
+		(*tcb_pp)->delay -= ticks;
+	*tcb_pp = tcb;
+}
+
+static void krnl_delay_update(uint32_t ticks)
+{
+	struct tcb_s *tcb_ptr;
+	
+	while ((tcb_ptr = kcb_p->delay_list) && tcb_ptr->delay <= ticks) {
+		ticks -= tcb_ptr->delay;
+		kcb_p->delay_list = tcb_ptr->delay_next;
+		krnl_task_state(tcb_ptr, TASK_READY);
+	}
+	if (tcb_ptr)
+		tcb_ptr->delay -= ticks;
 }
 
 static void krnl_sched_init(int32_t preemptive)
 {
 	kcb_p->tcb_p = kcb_p->tcb_first;
+	kcb_p->preemptive = preemptive;
+	/* tasks are initialized during the first tick, so periodic tasks are
+	 * released (time 0) on the first dispatch */
+	kcb_p->ticks = -1;
+#ifdef UCX_TASK_STATS
+	kcb_p->stats_stamp = _readcounter();
+#endif
 	if (preemptive) {
 		_timer_enable();
 	}
@@ -50,111 +117,484 @@ static void krnl_sched_init(int32_t preemptive)
 }
 
 
-/* task scheduler and dispatcher */
+/* binary min-heaps of TCBs, used for periodic task release and ready
+ * queues. keys are tick counts (or fixed priorities, on RM / DM ready
+ * queues), compared with wrap around. */
 
-uint16_t krnl_schedule(void)
+#define HEAP_NONE		0xffff
+#define time_before(a, b)	((int32_t)((a) - (b)) < 0)
+
+/* fixed priority of a periodic task, lower is higher (RM / DM) */
+static uint32_t krnl_rt_prio(struct tcb_s *tcb)
 {
-	do {
-		do {
-			kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
-		} while (kcb_p->tcb_p->state != TASK_READY || kcb_p->tcb_p->is_periodic);
-	} while (--kcb_p->tcb_p->priority & 0xff);
-	kcb_p->tcb_p->priority |= (kcb_p->tcb_p->priority >> 8) & 0xff;
+	return kcb_p->rt_policy == RT_POLICY_RM ? tcb->period : tcb->deadline;
+}
 
-	return kcb_p->tcb_p->id;
+/* a job holding a mutex may run with an inherited (earlier) key */
+static uint32_t krnl_heap_key(struct rt_heap_s *heap, struct tcb_s *tcb)
+{
+	uint32_t key;
+	
+	if (heap == &kcb_p->rel_heap)
+		return tcb->release;
+	
+	key = kcb_p->rt_policy == RT_POLICY_EDF ? tcb->abs_deadline : krnl_rt_prio(tcb);
+	if (tcb->inherits && time_before(tcb->inh_key, key))
+		return tcb->inh_key;
+	
+	return key;
 }
 
-// Set current task to READY
-// Consume current task's capacity if it is periodic
-// Tick period and deadline for all
-// For tasks with remaining period <= 0
-//      reset remaining period
-//      reset remaining capacity
-//      reset remaining deadline
-// For tasks with deadline <= 0
-//      set capacity = 0
-// Find periodic task with remaining capacity and earliest deadline
-// If found, select for execution
-// If not
-//      find non-periodic with the highest priority
-//      select for execution
-
-void tick_period_and_deadline() {
-	for(uint16_t i = 0; i < task_count; i++) {
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
+static uint16_t krnl_heap_idx(struct rt_heap_s *heap, struct tcb_s *tcb)
+{
+	return heap == &kcb_p->rel_heap ? tcb->rel_idx : tcb->edf_idx;
+}
 
-		if(!kcb_p->tcb_p->is_periodic) {
-			continue;
-		}
+static void krnl_heap_set(struct rt_heap_s *heap, uint16_t i, struct tcb_s *tcb)
+{
+	heap->node[i] = tcb;
+	if (heap == &kcb_p->rel_heap)
+		tcb->rel_idx = i;
+	else
+		tcb->edf_idx = i;
+}
 
-		kcb_p->tcb_p->remaining_period_ticks--;
-		kcb_p->tcb_p->remaining_deadline_ticks--;
+static void krnl_heap_up(struct rt_heap_s *heap, uint16_t i)
+{
+	struct tcb_s *tcb = heap->node[i];
+	uint32_t key = krnl_heap_key(heap, tcb);
+	uint16_t parent;
+	
+	while (i > 0) {
+		parent = (i - 1) >> 1;
+		if (!time_before(key, krnl_heap_key(heap, heap->node[parent])))
+			break;
+		krnl_heap_set(heap, i, heap->node[parent]);
+		i = parent;
 	}
+	krnl_heap_set(heap, i, tcb);
 }
 
-void handle_period_resets() {
-	for(uint16_t i = 0; i < task_count; i++) {
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
+static void krnl_heap_down(struct rt_heap_s *heap, uint16_t i)
+{
+	struct tcb_s *tcb = heap->node[i];
+	uint32_t key = krnl_heap_key(heap, tcb);
+	uint16_t child;
+	
+	while ((child = (i << 1) + 1) < heap->count) {
+		if (child + 1 < heap->count && time_before(krnl_heap_key(heap, heap->node[child + 1]),
+			krnl_heap_key(heap, heap->node[child])))
+			child++;
+		if (!time_before(krnl_heap_key(heap, heap->node[child]), key))
+			break;
+		krnl_heap_set(heap, i, heap->node[child]);
+		i = child;
+	}
+	krnl_heap_set(heap, i, tcb);
+}
 
-		if(!kcb_p->tcb_p->is_periodic) {
-			continue;
-		}
+static void krnl_heap_push(struct rt_heap_s *heap, struct tcb_s *tcb)
+{
+	krnl_heap_set(heap, heap->count++, tcb);
+	krnl_heap_up(heap, heap->count - 1);
+}
 
-		if(kcb_p->tcb_p->remaining_period_ticks <= 0) {
-			kcb_p->tcb_p->remaining_period_ticks = kcb_p->tcb_p->period;
-			kcb_p->tcb_p->remaining_deadline_ticks = kcb_p->tcb_p->deadline;
-			kcb_p->tcb_p->remaining_capacity_ticks = kcb_p->tcb_p->capacity;
-		}
+static void krnl_heap_remove(struct rt_heap_s *heap, uint16_t i)
+{
+	struct tcb_s *last;
+	
+	if (heap == &kcb_p->rel_heap)
+		heap->node[i]->rel_idx = HEAP_NONE;
+	else
+		heap->node[i]->edf_idx = HEAP_NONE;
+	
+	last = heap->node[--heap->count];
+	if (i == heap->count)
+		return;
+	
+	krnl_heap_set(heap, i, last);
+	krnl_heap_up(heap, i);
+	krnl_heap_down(heap, krnl_heap_idx(heap, last));
+}
+
+/* ready queues
+ * 
+ * non-periodic tasks in the TASK_READY or TASK_RUNNING states are kept in
+ * a circular list per priority level. a bitmap keeps track of non empty
+ * levels (level 0 on the MSB), so the highest priority ready task is found
+ * with a count leading zeros on the bitmap.
+ */
+
+#if defined(__riscv_zbb) || defined(__ARM_FEATURE_CLZ) || defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#define krnl_rq_first(map)	(__builtin_clz((uint32_t)(map)) - 24)
+#else
+static const uint8_t rq_clz4[16] = {4, 3, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0};
+#define krnl_rq_first(map)	((map) & 0xf0 ? rq_clz4[(map) >> 4] : 4 + rq_clz4[(map) & 0x0f])
+#endif
+
+static uint8_t krnl_rq_level(uint16_t priority)
+{
+	switch (priority) {
+	case TASK_CRIT_PRIO:	return 0;
+	case TASK_HIGH_PRIO:	return 1;
+	case TASK_NORMAL_PRIO:	return 2;
+	case TASK_LOW_PRIO:	return 3;
+	default:		return 4;
 	}
 }
 
-void drop_tasks_with_missed_deadlines() {
-	for(uint16_t i = 0; i < task_count; i++) {
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
+/* circular list insertion (at the tail), returns 1 if the list was empty */
+static uint8_t krnl_list_insert(struct tcb_s **head, struct tcb_s *tcb)
+{
+	if (*head) {
+		tcb->rq_next = *head;
+		tcb->rq_prev = (*head)->rq_prev;
+		(*head)->rq_prev->rq_next = tcb;
+		(*head)->rq_prev = tcb;
+		
+		return 0;
+	}
+	tcb->rq_next = tcb;
+	tcb->rq_prev = tcb;
+	*head = tcb;
+	
+	return 1;
+}
 
-		if(!kcb_p->tcb_p->is_periodic) {
-			continue;
-		}
+/* circular list removal, returns 1 if the list is left empty */
+static uint8_t krnl_list_remove(struct tcb_s **head, struct tcb_s *tcb)
+{
+	if (tcb->rq_next == tcb) {
+		*head = 0;
+		
+		return 1;
+	}
+	tcb->rq_prev->rq_next = tcb->rq_next;
+	tcb->rq_next->rq_prev = tcb->rq_prev;
+	if (*head == tcb)
+		*head = tcb->rq_next;
+	
+	return 0;
+}
 
-		if(kcb_p->tcb_p->remaining_capacity_ticks <= 0) {
-			continue;
-		}
+static void krnl_rq_insert(struct tcb_s *tcb)
+{
+	uint8_t level = krnl_rq_level(tcb->priority);
+	
+	if (krnl_list_insert(&kcb_p->rq_head[level], tcb))
+		kcb_p->rq_bitmap |= 0x80 >> level;
+}
 
-		if(kcb_p->tcb_p->remaining_deadline_ticks <= 0) {
-			printf("dm:%d\n", kcb_p->tcb_p->id);
-			kcb_p->tcb_p->remaining_capacity_ticks = 0;
-			kcb_p->deadline_misses++;
-		}
+static void krnl_rq_remove(struct tcb_s *tcb)
+{
+	uint8_t level = krnl_rq_level(tcb->priority);
+	
+	if (krnl_list_remove(&kcb_p->rq_head[level], tcb))
+		kcb_p->rq_bitmap &= ~(0x80 >> level);
+}
+
+/* constant bandwidth servers (CBS)
+ * 
+ * a server reserves a budget of ticks every period for a group of
+ * aperiodic tasks. servers are kept on the EDF ready queue as jobs,
+ * while at least one of their tasks is ready, and served tasks run in
+ * a round robin fashion inside the server. a server is represented by a
+ * TCB (not on the task list), where capacity is the budget and
+ * remaining_capacity_ticks is the budget left.
+ * 
+ * - when the budget is exhausted, it is recharged and the server deadline
+ *   is postponed by one period;
+ * - when a server becomes ready, a new deadline (one period from now) and
+ *   a full budget are assigned if the budget left can't be used before the
+ *   current deadline without exceeding the server bandwidth.
+ * 
+ * servers never miss deadlines, so periodic tasks are not disturbed by
+ * overload on aperiodic tasks.
+ */
+
+static void krnl_cbs_postpone(struct tcb_s *srv)
+{
+	srv->remaining_capacity_ticks = srv->capacity;
+	srv->abs_deadline += srv->period;
+	if (srv->edf_idx != HEAP_NONE)
+		krnl_heap_down(&kcb_p->edf_heap, srv->edf_idx);
+}
+
+static void krnl_cbs_consume(struct tcb_s *srv)
+{
+	if (--srv->remaining_capacity_ticks == 0)
+		krnl_cbs_postpone(srv);
+}
+
+static void krnl_cbs_insert(struct tcb_s *tcb)
+{
+	struct tcb_s *srv = tcb->server;
+	int32_t left;
+	
+	if (!krnl_list_insert(&srv->srv_rq, tcb))
+		return;
+	
+	left = (int32_t)(srv->abs_deadline - kcb_p->ticks);
+	if (left <= 0 || (uint32_t)srv->remaining_capacity_ticks * srv->period >= (uint32_t)left * srv->capacity) {
+		srv->abs_deadline = kcb_p->ticks + srv->period;
+		srv->remaining_capacity_ticks = srv->capacity;
 	}
+	krnl_heap_push(&kcb_p->edf_heap, srv);
 }
 
-uint16_t find_next_periodic_task(struct tcb_s *last_task) {
-	kcb_p->tcb_p = last_task;
+static void krnl_cbs_remove(struct tcb_s *tcb)
+{
+	struct tcb_s *srv = tcb->server;
+	
+	if (krnl_list_remove(&srv->srv_rq, tcb))
+		krnl_heap_remove(&kcb_p->edf_heap, srv->edf_idx);
+}
 
-	uint16_t earliest_deadline = 0xffff;
-	uint16_t task_id = -1;
+/* all task state changes go through here, so the ready queues are kept
+ * up to date. must be called with interrupts disabled. */
+void krnl_task_state(struct tcb_s *tcb, uint8_t state)
+{
+	uint8_t was_ready, is_ready;
+	
+	was_ready = tcb->state == TASK_READY || tcb->state == TASK_RUNNING;
+	is_ready = state == TASK_READY || state == TASK_RUNNING;
+	
+	if (tcb->server && was_ready != is_ready) {
+		if (is_ready)
+			krnl_cbs_insert(tcb);
+		else
+			krnl_cbs_remove(tcb);
+	} else if (!tcb->is_periodic && was_ready != is_ready) {
+		if (is_ready)
+			krnl_rq_insert(tcb);
+		else
+			krnl_rq_remove(tcb);
+	}
+	tcb->state = state;
+	
+	if (tcb->is_periodic && was_ready != is_ready) {
+		if (is_ready && tcb->remaining_capacity_ticks)
+			krnl_heap_push(&kcb_p->edf_heap, tcb);
+		else if (!is_ready && tcb->edf_idx != HEAP_NONE)
+			krnl_heap_remove(&kcb_p->edf_heap, tcb->edf_idx);
+	}
+}
 
-	for(uint16_t i = 0; i < task_count; i++) {
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
+/* priority inheritance
+ * 
+ * a task holding a mutex runs with the scheduling parameters of the most
+ * urgent task blocked on it: non-periodic tasks inherit a priority level,
+ * and periodic jobs inherit a ready queue key (a deadline on EDF, a fixed
+ * priority on RM / DM). periodic jobs always run before non-periodic tasks,
+ * so parameters are not inherited between the two classes, nor by tasks
+ * served by a CBS server. must be called with interrupts disabled.
+ */
 
-		if(!kcb_p->tcb_p->is_periodic) {
-			continue;
-		}
+/* task a is more urgent than task b */
+int32_t krnl_task_before(struct tcb_s *a, struct tcb_s *b)
+{
+	if (a->is_periodic != b->is_periodic)
+		return a->is_periodic;
+	if (a->is_periodic)
+		return time_before(krnl_heap_key(&kcb_p->edf_heap, a), krnl_heap_key(&kcb_p->edf_heap, b));
+	
+	return krnl_rq_level(a->priority) < krnl_rq_level(b->priority);
+}
 
-		if(kcb_p->tcb_p->remaining_capacity_ticks <= 0) {
-			continue;
-		}
+/* moves a task to the ready queue of a new priority level */
+static void krnl_task_prio(struct tcb_s *tcb, uint16_t priority)
+{
+	uint8_t state = tcb->state;
+	
+	krnl_task_state(tcb, TASK_STOPPED);
+	tcb->priority = priority;
+	krnl_task_state(tcb, state);
+}
+
+/* sets the inherited key of a job, and moves it on the ready queue */
+static void krnl_task_key(struct tcb_s *tcb, uint8_t inherits, uint32_t key)
+{
+	tcb->inherits = inherits;
+	tcb->inh_key = key;
+	if (tcb->edf_idx != HEAP_NONE) {
+		krnl_heap_up(&kcb_p->edf_heap, tcb->edf_idx);
+		krnl_heap_down(&kcb_p->edf_heap, tcb->edf_idx);
+	}
+}
 
-		if(kcb_p->tcb_p->remaining_deadline_ticks < earliest_deadline) {
-			earliest_deadline = kcb_p->tcb_p->remaining_deadline_ticks;
-			task_id = kcb_p->tcb_p->id;
+void krnl_task_inherit(struct tcb_s *tcb, struct tcb_s *from)
+{
+	if (tcb->server || from->server || tcb->is_periodic != from->is_periodic)
+		return;
+	if (!krnl_task_before(from, tcb))
+		return;
+	
+	if (tcb->is_periodic)
+		krnl_task_key(tcb, 1, krnl_heap_key(&kcb_p->edf_heap, from));
+	else
+		krnl_task_prio(tcb, from->priority);
+}
+
+void krnl_task_disinherit(struct tcb_s *tcb)
+{
+	if (tcb->inherits)
+		krnl_task_key(tcb, 0, 0);
+	if (tcb->priority != tcb->base_priority)
+		krnl_task_prio(tcb, tcb->base_priority);
+}
+
+
+/* task scheduler and dispatcher */
+
+uint16_t krnl_schedule(void)
+{
+	struct tcb_s *tcb_ptr = kcb_p->tcb_p;
+	uint8_t level;
+	
+	/* round robin inside a level: the current task goes to the tail */
+	if (!tcb_ptr->is_periodic && !tcb_ptr->server && (tcb_ptr->state == TASK_READY || tcb_ptr->state == TASK_RUNNING)) {
+		level = krnl_rq_level(tcb_ptr->priority);
+		if (kcb_p->rq_head[level] == tcb_ptr) {
+			kcb_p->rq_head[level] = tcb_ptr->rq_next;
+		} else {
+			krnl_rq_remove(tcb_ptr);
+			krnl_rq_insert(tcb_ptr);
 		}
 	}
+	
+	if (!kcb_p->rq_bitmap)
+		return tcb_ptr->id;
+	
+	if (tcb_ptr->state == TASK_RUNNING)
+		tcb_ptr->state = TASK_READY;
+	
+	level = krnl_rq_first(kcb_p->rq_bitmap);
+	kcb_p->tcb_p = kcb_p->rq_head[level];
+	kcb_p->tcb_p->state = TASK_RUNNING;
+
+	return kcb_p->tcb_p->id;
+}
+
+#ifdef UCX_TASK_STATS
+/* CPU time accounting, on every scheduling point. run time since the
+ * last scheduling point is charged to the previous task. */
+static void krnl_stats_update(struct tcb_s *prev, uint8_t preempt)
+{
+	struct tcb_s *next = kcb_p->tcb_p;
+	uint32_t now, delta;
+	
+	now = _readcounter();
+	delta = now - kcb_p->stats_stamp;
+	kcb_p->stats_stamp = now;
+	prev->stats.cycles += delta;
+	kcb_p->stats_slice += delta;
+	
+	if (next == prev)
+		return;
+	
+	if (kcb_p->stats_slice > prev->stats.max_slice)
+		prev->stats.max_slice = kcb_p->stats_slice;
+	kcb_p->stats_slice = 0;
+	if (preempt && prev->state == TASK_READY)
+		prev->stats.preemptions++;
+	next->stats.switches++;
+}
+#endif
+
+/* real time (EDF, RM / DM) scheduling
+ * 
+ * periodic tasks are kept in two binary min-heaps: a release queue, keyed
+ * by the next release time of each task, and a ready queue of jobs with
+ * remaining capacity, keyed by absolute deadline (EDF) or by a fixed
+ * priority derived from the task period (RM) or deadline (DM). CBS servers
+ * with ready tasks are also kept on the (EDF) ready queue. on every tick:
+ * 
+ * - the capacity of the current task (or the budget of its server) is
+ *   consumed;
+ * - tasks with a release time due get a new job (capacity and deadline
+ *   are reset) and are moved to their next release;
+ * - jobs that reached their deadline with remaining capacity are dropped
+ *   (on RM / DM, and for jobs that were not ready at their deadline, a
+ *   miss is detected when the next job is released);
+ * - the job on the ready queue root is selected. if there is none,
+ *   a non-periodic task is selected by krnl_schedule().
+ * 
+ * only heap roots are visited, so the cost of a tick is O(log n) on the
+ * number of periodic tasks. on RM / DM, keys never change, so a release
+ * doesn't move a job on the ready queue.
+ */
+
+static void krnl_rt_miss(struct tcb_s *tcb)
+{
+	krnl_trace(TRACE_MISS, tcb->id, 0);
+	tcb->remaining_capacity_ticks = 0;
+	kcb_p->deadline_misses++;
+	if (tcb->edf_idx != HEAP_NONE)
+		krnl_heap_remove(&kcb_p->edf_heap, tcb->edf_idx);
+}
+
+/* a job released again with remaining capacity didn't complete, whatever
+ * its state (a job blocked at its deadline isn't on the ready queue) */
+static void krnl_edf_release(struct tcb_s *tcb)
+{
+	if (tcb->remaining_capacity_ticks)
+		krnl_rt_miss(tcb);
+	
+	tcb->remaining_capacity_ticks = tcb->capacity;
+	tcb->abs_deadline = tcb->release + tcb->deadline;
+	tcb->release += tcb->period;
+	krnl_heap_down(&kcb_p->rel_heap, tcb->rel_idx);
+	
+	if (tcb->edf_idx != HEAP_NONE) {
+		if (kcb_p->rt_policy != RT_POLICY_EDF)
+			return;
+		krnl_heap_up(&kcb_p->edf_heap, tcb->edf_idx);
+		krnl_heap_down(&kcb_p->edf_heap, tcb->edf_idx);
+	} else {
+		if (tcb->state == TASK_READY || tcb->state == TASK_RUNNING)
+			krnl_heap_push(&kcb_p->edf_heap, tcb);
+	}
+}
 
-	return task_id;
+static struct tcb_s *krnl_edf_schedule(struct tcb_s *preempted_task)
+{
+	struct rt_heap_s *edf = &kcb_p->edf_heap;
+	struct tcb_s *tcb_ptr, *current;
+	
+	/* releases */
+	while (kcb_p->rel_heap.count && !time_before(kcb_p->ticks, kcb_p->rel_heap.node[0]->release))
+		krnl_edf_release(kcb_p->rel_heap.node[0]);
+	
+	/* deadline misses */
+	if (kcb_p->rt_policy == RT_POLICY_EDF) {
+		while (edf->count && !time_before(kcb_p->ticks, edf->node[0]->abs_deadline)) {
+			if (edf->node[0]->is_server)
+				krnl_cbs_postpone(edf->node[0]);
+			else
+				krnl_rt_miss(edf->node[0]);
+		}
+	}
+	
+	if (!edf->count)
+		return 0;
+	
+	/* on a tie, keep the current job running */
+	tcb_ptr = edf->node[0];
+	current = preempted_task->server ? preempted_task->server : preempted_task;
+	if (current->edf_idx != HEAP_NONE && krnl_heap_key(edf, current) == krnl_heap_key(edf, tcb_ptr))
+		tcb_ptr = current;
+	
+	/* round robin inside a server */
+	if (tcb_ptr->is_server) {
+		if (tcb_ptr->srv_rq == preempted_task)
+			tcb_ptr->srv_rq = preempted_task->rq_next;
+		tcb_ptr = tcb_ptr->srv_rq;
+	}
+	
+	return tcb_ptr;
 }
 
-void print_report() {
+void trace_report() {
 	uint16_t tasks_run = 0;
 	for(uint16_t i = 0; i < task_count; i++) {
 		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
@@ -164,16 +604,12 @@ void print_report() {
 		}
 	}
 
-	printf("=================================================\n");
-	printf("Report:\n");
-	printf("Deadline misses: %d\n", kcb_p->deadline_misses);
-	printf("Jobs run: %d\n", tasks_run);
-	printf("=================================================\n");
+	krnl_trace(TRACE_REPORT, 0, ((uint32_t)kcb_p->deadline_misses << 16) | tasks_run);
 }
 
 void run_statistics_stuff() {
 	if(kcb_p->ticks_until_next_report <= 0) {
-		print_report();
+		trace_report();
 
 		kcb_p->ticks_until_next_report = kcb_p->periods_least_common_multiple;
 		kcb_p->deadline_misses = 0;
@@ -185,6 +621,20 @@ void run_statistics_stuff() {
 	kcb_p->ticks_until_next_report--;
 }
 
+/* periodic jobs (and CBS servers) first, then non-periodic tasks */
+static void krnl_select(struct tcb_s *prev)
+{
+	struct tcb_s *next_task;
+	
+	next_task = krnl_edf_schedule(prev);
+	if (next_task)
+		kcb_p->tcb_p = next_task;
+	else
+		krnl_schedule();
+
+	kcb_p->tcb_p->state = TASK_RUNNING;
+}
+
 uint16_t krnl_rt_schedule() {
 	struct tcb_s *preempted_task = kcb_p->tcb_p;
 
@@ -195,85 +645,234 @@ uint16_t krnl_rt_schedule() {
 	if (kcb_p->tcb_p->state == TASK_RUNNING) {
 		kcb_p->tcb_p->state = TASK_READY;
 
-		if (kcb_p->tcb_p->is_periodic) {
-			kcb_p->tcb_p->remaining_capacity_ticks--;
+		if (kcb_p->tcb_p->is_periodic && kcb_p->tcb_p->remaining_capacity_ticks) {
+			if (--kcb_p->tcb_p->remaining_capacity_ticks == 0)
+				krnl_heap_remove(&kcb_p->edf_heap, kcb_p->tcb_p->edf_idx);
 		}
+		if (kcb_p->tcb_p->server)
+			krnl_cbs_consume(kcb_p->tcb_p->server);
 	}
 
-	tick_period_and_deadline();
-	handle_period_resets();
-	drop_tasks_with_missed_deadlines();
-
-	uint16_t next_task_id = find_next_periodic_task(preempted_task);
-	if(next_task_id == (uint16_t)-1) {
-		next_task_id = krnl_schedule();
-	}
-
-	for(uint16_t i = 0; i < task_count; i++) {
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
-
-		if (kcb_p->tcb_p->id == next_task_id) {
-			break;
-		}
-	}
+	kcb_p->ticks++;
 
-	kcb_p->tcb_p->state = TASK_RUNNING;
+	krnl_select(preempted_task);
 	kcb_p->tcb_p->has_run_in_lcm = 1;
 	kcb_p->ctx_switches++;
+#ifdef UCX_TASK_STATS
+	krnl_stats_update(preempted_task, 1);
+#endif
 
 #ifdef SCHEDULER_DEBUG
-	printf("%d\n", next_task_id);
+	krnl_trace(TRACE_TICK, kcb_p->tcb_p->id, 0);
 #else
 	preempted_task->continuous_capacity_consumed++;
 	if(kcb_p->tcb_p != preempted_task) {
-		printf("Task consumed %d capacity units\n",  preempted_task->continuous_capacity_consumed);
+		krnl_trace(TRACE_SWITCH, kcb_p->tcb_p->id,
+			((uint32_t)preempted_task->continuous_capacity_consumed << 16) | preempted_task->id);
 		preempted_task->continuous_capacity_consumed = 0;
+	}
+#endif
+	return kcb_p->tcb_p->id;
+}
+
+#ifdef UCX_TICKLESS
+/* tickless idle
+ * 
+ * when only the idle task is ready, the timer is programmed for the next
+ * kernel event instead of the next tick, and the CPU waits for interrupts
+ * in the meantime. the next event is the earliest of the delay queue head,
+ * the next periodic release, the next timer expiration and the next
+ * statistics report. deadlines and capacity are not considered, as no
+ * periodic job is ready while idling.
+ * on wakeup, the dispatcher accounts for all elapsed ticks at once.
+ */
 
-		printf("Running task %d\n", kcb_p->tcb_p->id);
+#define TICKLESS_MAX		0xffff
+
+static uint32_t krnl_next_event(void)
+{
+	uint8_t idle_level = krnl_rq_level(TASK_IDLE_PRIO);
+	uint32_t next = TICKLESS_MAX;
+	int32_t release;
+	
+	/* some other task is ready, keep ticking */
+	if (kcb_p->edf_heap.count || kcb_p->rq_bitmap != (0x80 >> idle_level) ||
+		kcb_p->rq_head[idle_level]->rq_next != kcb_p->rq_head[idle_level])
+		return 1;
+	
+	if (kcb_p->delay_list && kcb_p->delay_list->delay < next)
+		next = kcb_p->delay_list->delay;
+	
+	if (kcb_p->rel_heap.count) {
+		release = (int32_t)(kcb_p->rel_heap.node[0]->release - kcb_p->ticks);
+		if (release < 1)
+			return 1;
+		if ((uint32_t)release < next)
+			next = release;
 	}
+	
+#ifndef SCHEDULER_DEBUG
+	if ((uint32_t)kcb_p->ticks_until_next_report + 1 < next)
+		next = kcb_p->ticks_until_next_report + 1;
 #endif
-	return next_task_id;
+	
+	return krnl_timer_next(next);
 }
 
+/* a task woken by an interrupt other than the tick (the console) runs
+ * right away, instead of on the next timer event */
+static void krnl_idle(void)
+{
+	ucx_critical_enter();
+	_timer_oneshot(krnl_next_event());
+	_cpu_idle();
+	ucx_critical_leave();
+	krnl_reschedule();
+}
+
+/* returns the number of ticks since the last dispatch. tick counters
+ * are updated here for all but the current tick, which is accounted as
+ * usual by the scheduler. */
+static uint32_t krnl_tick_elapsed(void)
+{
+	uint32_t ticks, skipped;
+	
+	ticks = _timer_ticks();
+	if (ticks < 2)
+		return 1;
+	
+	skipped = ticks - 1;
+	kcb_p->ticks += skipped;
+	kcb_p->tcb_p->continuous_capacity_consumed += skipped;
+#ifndef SCHEDULER_DEBUG
+	if (skipped < kcb_p->ticks_until_next_report)
+		kcb_p->ticks_until_next_report -= skipped;
+	else
+		kcb_p->ticks_until_next_report = 0;
+#endif
+	
+	return ticks;
+}
+#endif
+
 void krnl_dispatcher(void)
 {
+	uint32_t ticks;
+	
 //    printf("|%d|", dispatch_count++);
 	if (!setjmp(kcb_p->tcb_p->context)) {
-		krnl_delay_update();
+#ifdef UCX_TICKLESS
+		ticks = krnl_tick_elapsed();
+#else
+		ticks = 1;
+#endif
+		krnl_delay_update(ticks);
+		krnl_timer_tick(ticks);
 		krnl_guard_check();
 		krnl_rt_schedule();
+#ifdef UCX_TICKLESS
+		_timer_oneshot(1);
+#endif
 		_interrupt_tick();
 		longjmp(kcb_p->tcb_p->context, 1);
 	}
 }
 
+/* immediate context switch
+ * 
+ * a task that blocks, or that wakes up a task that would be selected in its
+ * place, doesn't wait for the next tick: a new task is selected right away.
+ * time is not accounted here (capacity, budgets and delays are consumed on
+ * ticks only). in cooperative mode, a switch happens only if the current
+ * task is blocked. must be called outside of critical sections.
+ */
+
+/* a ready task would be selected instead of the current one */
+static int32_t krnl_preempted(void)
+{
+	struct rt_heap_s *edf = &kcb_p->edf_heap;
+	struct tcb_s *cur = kcb_p->tcb_p;
+	
+	if (cur->server)
+		cur = cur->server;
+	if (cur->edf_idx != HEAP_NONE)
+		return time_before(krnl_heap_key(edf, edf->node[0]), krnl_heap_key(edf, cur));
+	if (edf->count)
+		return 1;
+	
+	return kcb_p->rq_bitmap && krnl_rq_first(kcb_p->rq_bitmap) < krnl_rq_level(cur->priority);
+}
+
+void krnl_reschedule(void)
+{
+	struct tcb_s *prev = kcb_p->tcb_p;
+	int32_t status;
+	
+	status = _di();
+	if (prev->state == TASK_RUNNING && (!kcb_p->preemptive || !krnl_preempted())) {
+		_ei(status);
+		return;
+	}
+	
+	if (!setjmp(prev->context)) {
+		if (prev->state == TASK_RUNNING)
+			prev->state = TASK_READY;
+		krnl_select(prev);
+		kcb_p->ctx_switches++;
+#ifdef UCX_TASK_STATS
+		krnl_stats_update(prev, 1);
+#endif
+		longjmp(kcb_p->tcb_p->context, 1);
+	}
+	_ei(status);
+}
+
 
 /* task management API */
 
 int32_t ucx_task_add(void *task, uint16_t guard_size)
 {
 	struct tcb_s *tcb_last = kcb_p->tcb_p;
+	struct tcb_s *tcb;
 	
-	kcb_p->tcb_p = (struct tcb_s *)malloc(sizeof(struct tcb_s));
+	tcb = (struct tcb_s *)ucx_pool_alloc(&tcb_pool);
+	if (!tcb)
+		return -1;
+	
+	if (krnl_tcb_register(tcb)) {
+		ucx_pool_free(&tcb_pool, tcb);
+		return -1;
+	}
+	
+	kcb_p->tcb_p = tcb;
 	if (kcb_p->tcb_first == 0) {
 		kcb_p->tcb_first = kcb_p->tcb_p;
 	}
 
-	if (!kcb_p->tcb_p)
-		return -1;
-
 	if (tcb_last)
 		tcb_last->tcb_next = kcb_p->tcb_p;
 	kcb_p->tcb_p->tcb_next = kcb_p->tcb_first;
 	kcb_p->tcb_p->task = task;
 	kcb_p->tcb_p->delay = 0;
 	kcb_p->tcb_p->guard_sz = guard_size;
-	kcb_p->tcb_p->id = kcb_p->id++;
 	kcb_p->tcb_p->state = TASK_STOPPED;
 	kcb_p->tcb_p->priority = TASK_NORMAL_PRIO;
 	kcb_p->tcb_p->is_periodic = 0;
+	kcb_p->tcb_p->remaining_capacity_ticks = 0;
+	kcb_p->tcb_p->rel_idx = HEAP_NONE;
+	kcb_p->tcb_p->edf_idx = HEAP_NONE;
+	kcb_p->tcb_p->server = 0;
+	kcb_p->tcb_p->is_server = 0;
 	kcb_p->tcb_p->has_run_in_lcm = 0;
 	kcb_p->tcb_p->continuous_capacity_consumed = 0;
+	kcb_p->tcb_p->base_priority = TASK_NORMAL_PRIO;
+	kcb_p->tcb_p->inherits = 0;
+	kcb_p->tcb_p->mtx_held = 0;
+	kcb_p->tcb_p->mtx_wait = 0;
+	kcb_p->tcb_p->wait_next = 0;
+#ifdef UCX_TASK_STATS
+	memset(&kcb_p->tcb_p->stats, 0, sizeof(struct task_stats_s));
+#endif
 
 
 	task_count++;
@@ -281,22 +880,207 @@ int32_t ucx_task_add(void *task, uint16_t guard_size)
 	return 0;
 }
 
+/* RM / DM admission control
+ * 
+ * a task set is accepted if its utilization is below the Liu and Layland
+ * bound (RM with deadlines equal to periods) or if the worst case response
+ * time of every task is within its deadline. the response time of a task
+ * is the fixed point of R = C + sum(ceil(R / Tj) * Cj), for all tasks j of
+ * equal or higher priority.
+ */
+
+/* n * (2^(1/n) - 1), scaled by 10000. ln(2) is used above 10 tasks */
+static const uint16_t rt_ubound[10] = {10000, 8284, 7797, 7568, 7434, 7347, 7286, 7240, 7205, 7177};
+
+static struct tcb_s *krnl_rt_task(uint16_t i, struct tcb_s *new_tcb)
+{
+	return i < kcb_p->rel_heap.count ? kcb_p->rel_heap.node[i] : new_tcb;
+}
+
+static int32_t krnl_rt_response(struct tcb_s *tcb, struct tcb_s *new_tcb)
+{
+	struct tcb_s *hp;
+	uint32_t r, next = tcb->capacity;
+	uint16_t i;
+	
+	do {
+		r = next;
+		next = tcb->capacity;
+		for (i = 0; i <= kcb_p->rel_heap.count; i++) {
+			hp = krnl_rt_task(i, new_tcb);
+			if (hp == tcb || krnl_rt_prio(hp) > krnl_rt_prio(tcb))
+				continue;
+			next += (r + hp->period - 1) / hp->period * hp->capacity;
+		}
+		if (next > tcb->deadline)
+			return -1;
+	} while (next != r);
+	
+	return 0;
+}
+
+static int32_t krnl_rt_admit(struct tcb_s *new_tcb)
+{
+	struct tcb_s *tcb;
+	uint32_t util = 0;
+	uint16_t i, n = kcb_p->rel_heap.count + 1;
+	uint8_t implicit = 1;
+	
+	if (!new_tcb->capacity || new_tcb->capacity > new_tcb->deadline || new_tcb->deadline > new_tcb->period)
+		return -1;
+	
+	for (i = 0; i < n; i++) {
+		tcb = krnl_rt_task(i, new_tcb);
+		util += ((uint32_t)tcb->capacity * 10000 + tcb->period - 1) / tcb->period;
+		if (tcb->deadline != tcb->period)
+			implicit = 0;
+	}
+	if (util > 10000)
+		return -1;
+	if (kcb_p->rt_policy == RT_POLICY_RM && implicit && util <= (n <= 10 ? rt_ubound[n - 1] : 6931))
+		return 0;
+	
+	for (i = 0; i < n; i++)
+		if (krnl_rt_response(krnl_rt_task(i, new_tcb), new_tcb))
+			return -1;
+	
+	return 0;
+}
+
 int32_t ucx_task_add_periodic(void *task, uint16_t period, uint16_t capacity, uint16_t deadline, uint16_t guard_size) {
+	struct tcb_s **node;
+	struct tcb_s new_tcb;
+	uint16_t size = (kcb_p->rel_heap.count + 1) * sizeof(struct tcb_s *);
+
+	if (kcb_p->rt_policy != RT_POLICY_EDF) {
+		new_tcb.period = period;
+		new_tcb.capacity = capacity;
+		new_tcb.deadline = deadline;
+		if (krnl_rt_admit(&new_tcb))
+			return -1;
+	}
+
+	/* make room for one more task on both periodic queues */
+	node = (struct tcb_s **)realloc(kcb_p->rel_heap.node, size);
+	if (!node)
+		return -1;
+	kcb_p->rel_heap.node = node;
+
+	node = (struct tcb_s **)realloc(kcb_p->edf_heap.node, size + kcb_p->cbs_count * sizeof(struct tcb_s *));
+	if (!node)
+		return -1;
+	kcb_p->edf_heap.node = node;
+
 	if(ucx_task_add(task, guard_size)) {
 		return -1;
 	}
 
 	kcb_p->tcb_p->period = period;
-	kcb_p->tcb_p->remaining_period_ticks = period;
 	kcb_p->tcb_p->capacity = capacity;
 	kcb_p->tcb_p->remaining_capacity_ticks = capacity;
 	kcb_p->tcb_p->deadline = deadline;
-	kcb_p->tcb_p->remaining_deadline_ticks = deadline;
+	kcb_p->tcb_p->release = kcb_p->ticks + period;
+	kcb_p->tcb_p->abs_deadline = kcb_p->ticks + deadline;
 	kcb_p->tcb_p->is_periodic = 1;
+	krnl_heap_push(&kcb_p->rel_heap, kcb_p->tcb_p);
+
+	return 0;
+}
 
+int32_t ucx_rt_policy(uint8_t policy)
+{
+	if (policy > RT_POLICY_DM || kcb_p->rel_heap.count || kcb_p->cbs_count)
+		return -1;
+	
+	kcb_p->rt_policy = policy;
+	
 	return 0;
 }
 
+/* CBS servers are available on the EDF policy only. returns a server id */
+int32_t ucx_cbs_create(uint16_t budget, uint16_t period)
+{
+	struct tcb_s **node;
+	struct tcb_s *srv;
+	uint16_t size = (kcb_p->rel_heap.count + kcb_p->cbs_count + 1) * sizeof(struct tcb_s *);
+	
+	if (kcb_p->rt_policy != RT_POLICY_EDF || !budget || budget > period)
+		return -1;
+	
+	/* make room for one more job on the ready queue */
+	node = (struct tcb_s **)realloc(kcb_p->edf_heap.node, size);
+	if (!node)
+		return -1;
+	kcb_p->edf_heap.node = node;
+	
+	srv = (struct tcb_s *)ucx_pool_alloc(&tcb_pool);
+	if (!srv)
+		return -1;
+	
+	if (krnl_tcb_register(srv)) {
+		ucx_pool_free(&tcb_pool, srv);
+		return -1;
+	}
+	
+	srv->tcb_next = kcb_p->cbs_first;
+	srv->is_server = 1;
+	srv->is_periodic = 0;
+	srv->server = 0;
+	srv->srv_rq = 0;
+	srv->period = period;
+	srv->deadline = period;
+	srv->capacity = budget;
+	srv->remaining_capacity_ticks = budget;
+	srv->abs_deadline = kcb_p->ticks;
+	srv->rel_idx = HEAP_NONE;
+	srv->edf_idx = HEAP_NONE;
+	srv->inherits = 0;
+	kcb_p->cbs_first = srv;
+	kcb_p->cbs_count++;
+	
+	return srv->id;
+}
+
+/* attaches an aperiodic task to a CBS server, before the task is started */
+int32_t ucx_task_cbs(uint16_t id, uint16_t server)
+{
+	struct tcb_s *tcb_ptr = krnl_task(id);
+	struct tcb_s *srv = krnl_tcb(server);
+	
+	if (!srv || !srv->is_server || !tcb_ptr)
+		return -1;
+	
+	if (tcb_ptr->state != TASK_STOPPED || tcb_ptr->is_periodic)
+		return -1;
+	tcb_ptr->server = srv;
+	
+	return 0;
+}
+
+/* the guard space is allocated below the initial task context, so code
+ * running on a task resume (and interrupts) can't overwrite the stack of
+ * the next task */
+static void krnl_guard_init(void)
+{
+	char guard[kcb_p->tcb_p->guard_sz];
+	
+	memset(guard, 0x69, kcb_p->tcb_p->guard_sz);
+	memset(guard, 0x33, 4);
+	memset((guard) + kcb_p->tcb_p->guard_sz - 4, 0x33, 4);
+	kcb_p->tcb_p->guard_addr = (uint32_t *)guard;
+	//printf("task %d, guard: %08x - %08x\n", kcb_p->tcb_p->id, (size_t)kcb_p->tcb_p->guard_addr,
+	//	(size_t)kcb_p->tcb_p->guard_addr + kcb_p->tcb_p->guard_sz);
+	
+	krnl_task_state(kcb_p->tcb_p, TASK_READY);
+	if (kcb_p->tcb_p->tcb_next == kcb_p->tcb_first) {
+		krnl_task_state(kcb_p->tcb_p, TASK_RUNNING);
+	} else {
+		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
+		krnl_task_state(kcb_p->tcb_p, TASK_RUNNING);
+		(*kcb_p->tcb_p->task)();
+	}
+}
+
 /*
  * First following lines of code are absurd at best. Stack marks are
  * used by krnl_guard_check() to detect stack overflows on guard space.
@@ -320,67 +1104,62 @@ int32_t ucx_task_add_periodic(void *task, uint16_t period, uint16_t capacity, ui
 	   /,_|  |   /,_/   /
 		  /,_/      '`-'
 */
+
 void ucx_task_init(void)
 {
-	char guard[kcb_p->tcb_p->guard_sz];
-	
-	memset(guard, 0x69, kcb_p->tcb_p->guard_sz);
-	memset(guard, 0x33, 4);
-	memset((guard) + kcb_p->tcb_p->guard_sz - 4, 0x33, 4);
-	kcb_p->tcb_p->guard_addr = (uint32_t *)guard;
-	//printf("task %d, guard: %08x - %08x\n", kcb_p->tcb_p->id, (size_t)kcb_p->tcb_p->guard_addr,
-	//	(size_t)kcb_p->tcb_p->guard_addr + kcb_p->tcb_p->guard_sz);
-	
-	if (!setjmp(kcb_p->tcb_p->context)) {
-		kcb_p->tcb_p->state = TASK_READY;
-		if (kcb_p->tcb_p->tcb_next == kcb_p->tcb_first) {
-			kcb_p->tcb_p->state = TASK_RUNNING;
-		} else {
-			kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
-			kcb_p->tcb_p->state = TASK_RUNNING;
-			(*kcb_p->tcb_p->task)();
-		}
-	}
+	if (!setjmp(kcb_p->tcb_p->context))
+		krnl_guard_init();
 	_ei(1);
 }
 
 void ucx_task_yield()
 {
+#ifdef UCX_TASK_STATS
+	struct tcb_s *prev = kcb_p->tcb_p;
+#endif
+	int32_t status;
+	
+	/* a tick during a yield would save the context of the wrong task */
+	status = _di();
 	if (!setjmp(kcb_p->tcb_p->context)) {
-		krnl_delay_update();		/* TODO: check if we need to run a delay update on yields. maybe only on a non-preemtive execution? */ 
+		krnl_delay_update(1);		/* TODO: check if we need to run a delay update on yields. maybe only on a non-preemtive execution? */ 
 		krnl_guard_check();
 		krnl_schedule();
+#ifdef UCX_TASK_STATS
+		krnl_stats_update(prev, 0);
+#endif
 		longjmp(kcb_p->tcb_p->context, 1);
 	}
+	_ei(status);
 }
 
 void ucx_task_delay(uint16_t ticks)
 {
-	kcb_p->tcb_p->delay = ticks;
-	kcb_p->tcb_p->state = TASK_BLOCKED;
+	if (ticks) {
+		ucx_critical_enter();
+		krnl_delay_insert(kcb_p->tcb_p, ticks);
+		krnl_task_state(kcb_p->tcb_p, TASK_BLOCKED);
+		ucx_critical_leave();
+	}
 	ucx_task_yield();
 }
 
 int32_t ucx_task_suspend(uint16_t id)
 {
-	struct tcb_s *tcb_ptr = kcb_p->tcb_first;
-	
-	for (;; tcb_ptr = tcb_ptr->tcb_next) {
-		if (tcb_ptr->id == id) {
-			ucx_critical_enter();
-			if (tcb_ptr->state == TASK_READY || tcb_ptr->state == TASK_RUNNING) {
-				tcb_ptr->state = TASK_SUSPENDED;
-				ucx_critical_leave();
-				break;
-			} else {
-				ucx_critical_leave();
-				return -1;
-			}
-		}
-		if (tcb_ptr->tcb_next == kcb_p->tcb_first)
-			return -1;
+	struct tcb_s *tcb_ptr = krnl_task(id);
+	
+	if (!tcb_ptr)
+		return -1;
+	
+	ucx_critical_enter();
+	if (tcb_ptr->state == TASK_READY || tcb_ptr->state == TASK_RUNNING) {
+		krnl_task_state(tcb_ptr, TASK_SUSPENDED);
+		ucx_critical_leave();
+	} else {
+		ucx_critical_leave();
+		return -1;
 	}
-	if (kcb_p->tcb_p->id == id)
+	if (kcb_p->tcb_p == tcb_ptr)
 		ucx_task_yield();
 	
 	return 0;
@@ -388,24 +1167,20 @@ int32_t ucx_task_suspend(uint16_t id)
 
 int32_t ucx_task_resume(uint16_t id)
 {
-	struct tcb_s *tcb_ptr = kcb_p->tcb_first;
-	
-	for (;; tcb_ptr = tcb_ptr->tcb_next) {
-		if (tcb_ptr->id == id) {
-			ucx_critical_enter();
-			if (tcb_ptr->state == TASK_SUSPENDED) {
-				tcb_ptr->state = TASK_READY;
-				ucx_critical_leave();
-				break;
-			} else {
-				ucx_critical_leave();
-				return -1;
-			}
-		}	
-		if (tcb_ptr->tcb_next == kcb_p->tcb_first)
-			return -1;
+	struct tcb_s *tcb_ptr = krnl_task(id);
+	
+	if (!tcb_ptr)
+		return -1;
+	
+	ucx_critical_enter();
+	if (tcb_ptr->state == TASK_SUSPENDED) {
+		krnl_task_state(tcb_ptr, TASK_READY);
+		ucx_critical_leave();
+	} else {
+		ucx_critical_leave();
+		return -1;
 	}
-	if (kcb_p->tcb_p->id == id)
+	if (kcb_p->tcb_p == tcb_ptr)
 		ucx_task_yield();
 	
 	return 0;
@@ -413,7 +1188,7 @@ int32_t ucx_task_resume(uint16_t id)
 
 int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 {
-	struct tcb_s *tcb_ptr = kcb_p->tcb_first;
+	struct tcb_s *tcb_ptr = krnl_task(id);
 
 	switch (priority) {
 	case TASK_CRIT_PRIO:
@@ -426,14 +1201,19 @@ int32_t ucx_task_priority(uint16_t id, uint16_t priority)
 		return -1;
 	}
 	
-	for (;; tcb_ptr = tcb_ptr->tcb_next) {
-		if (tcb_ptr->id == id) {
-			tcb_ptr->priority = priority;
-			break;
-		}
-		if (tcb_ptr->tcb_next == kcb_p->tcb_first)
-			return -1;
-	}
+	if (!tcb_ptr)
+		return -1;
+	
+	/* the task is moved to the ready queue of its new level, unless it
+	 * inherits a higher priority from waiters of its mutexes. the owner
+	 * of a mutex the task waits for inherits the new priority. */
+	ucx_critical_enter();
+	tcb_ptr->base_priority = priority;
+	if (tcb_ptr->state == TASK_STOPPED)
+		tcb_ptr->priority = priority;
+	else
+		krnl_mutex_priority(tcb_ptr);
+	ucx_critical_leave();
 	
 	return 0;
 }
@@ -456,14 +1236,54 @@ uint16_t ucx_task_count()
 	return task_count;
 }
 
+#ifdef UCX_TASK_STATS
+/* run time of the current task is accounted up to the last tick */
+int32_t ucx_task_stats(uint16_t id, struct task_stats_s *stats)
+{
+	struct tcb_s *tcb_ptr = krnl_task(id);
+	
+	if (!tcb_ptr)
+		return -1;
+	
+	ucx_critical_enter();
+	memcpy(stats, &tcb_ptr->stats, sizeof(struct task_stats_s));
+	ucx_critical_leave();
+	
+	return 0;
+}
+#endif
+
+/* critical sections mask the tick and the other interrupts as well, as
+ * interrupt handlers (the console) may wake tasks too. sections nest: the
+ * outermost one saves the interrupt state, and leaving it enables
+ * interrupts only if they were enabled on enter, so a critical section
+ * can be used with interrupts disabled or in interrupt handlers. a task
+ * must not block or yield inside a critical section. */
+static volatile uint16_t critical_nest = 0;
+static volatile int32_t critical_status = 0;
+
 void ucx_critical_enter()
 {
-	_timer_disable();
+	int32_t status;
+	
+	status = _di();
+	if (!critical_nest++) {
+		critical_status = status;
+		if (status)
+			_timer_disable();
+	}
 }
 
 void ucx_critical_leave()
 {
-	_timer_enable();
+	if (!critical_nest || --critical_nest)
+		return;
+	
+	if (critical_status) {
+		critical_status = 0;
+		_timer_enable();
+		_ei(1);
+	}
 }
 
 
@@ -471,7 +1291,14 @@ void ucx_critical_leave()
 
 void idle(void) {
 	ucx_task_init();
-	for(;;){}
+	for(;;){
+		if (!kcb_p->preemptive)
+			ucx_task_yield();
+#ifdef UCX_TICKLESS
+		else
+			krnl_idle();
+#endif
+	}
 }
 
 void calculate_periods_lcm() {
@@ -512,14 +1339,23 @@ void calculate_periods_lcm() {
 
 int32_t main(void)
 {
+	struct tcb_s *idle_tcb;
 	int32_t pr;
 	
 	_hardware_init();
 	
 	kcb_p->tcb_p = 0;
 	kcb_p->tcb_first = 0;
+	kcb_p->tcb_tab = 0;
+	kcb_p->tcb_tab_size = 0;
 	kcb_p->ctx_switches = 0;
+	kcb_p->ticks = 0;
+	kcb_p->delay_list = 0;
 	kcb_p->id = 0;
+	kcb_p->rq_bitmap = 0;
+	kcb_p->rt_policy = RT_POLICY_EDF;
+	kcb_p->cbs_first = 0;
+	kcb_p->cbs_count = 0;
 	
 	printf("UCX/OS boot on %s\n", __ARCH__);
 #ifndef UCX_OS_HEAP_SIZE
@@ -529,24 +1365,24 @@ int32_t main(void)
 	ucx_heap_init((size_t *)&_heap, UCX_OS_HEAP_SIZE);
 	printf("heap_init(), %d bytes free\n", UCX_OS_HEAP_SIZE);
 #endif
+	krnl_console_init();
 	printf("x\n");
 
+	/* a TCB is kept for the idle task, so it is there even if the
+	 * application takes all the pool holds */
+	idle_tcb = ucx_pool_alloc(&tcb_pool);
 
 	pr = app_main();
 
-	uint8_t has_aperiodic = 0;
-	for(uint16_t i = 0; i < task_count; i++) {
-		if(!kcb_p->tcb_p->is_periodic) {
-			has_aperiodic = 1;
-		}
-
-		kcb_p->tcb_p = kcb_p->tcb_p->tcb_next;
-	}
-
-	if(!has_aperiodic) {
-		ucx_task_add(idle, DEFAULT_GUARD_SIZE);
-		ucx_task_priority(kcb_p->tcb_p->id, TASK_IDLE_PRIO);
+	/* the idle task is always there, so the scheduler always finds a ready task */
+	krnl_timer_init();
+	if (idle_tcb)
+		ucx_pool_free(&tcb_pool, idle_tcb);
+	if (!idle_tcb || ucx_task_add(idle, DEFAULT_GUARD_SIZE)) {
+		printf("\n*** HALT - no memory for the idle task\n");
+		for (;;);
 	}
+	ucx_task_priority(kcb_p->tcb_p->id, TASK_IDLE_PRIO);
 
 	calculate_periods_lcm();
 	kcb_p->ticks_until_next_report = kcb_p->periods_least_common_multiple;
@@ -17,7 +17,7 @@ void ucx_printhex(int n, int digits)
 			a = a + '7';
 		else
 			a = a + '0';
-		_putchar(a);
+		console_putchar(a);
 	}
 }
 
@@ -28,21 +28,21 @@ int32_t ucx_hexdump(char *buf, uint32_t size)
 
 	buf = (char *)((size_t)buf & ~0xf);
 	for (k = 0; k < size; k += 16) {
-		_putchar('\n'); ucx_printhex((size_t)buf + k, 8); _putchar(' ');
+		console_putchar('\n'); ucx_printhex((size_t)buf + k, 8); console_putchar(' ');
 		for(l = 0; l < 16; l++){
 			ucx_printhex((uint8_t)buf[k + l], 2);
-			_putchar(' ');
-			if (l == 7) _putchar(' ');
+			console_putchar(' ');
+			if (l == 7) console_putchar(' ');
 		}
-		_putchar(' '); _putchar('|');
+		console_putchar(' '); console_putchar('|');
 		for (l = 0; l < 16; l++) {
 			ch = (uint8_t)buf[k + l];
 			if ((ch >= 32) && (ch <= 126))
-				_putchar(ch);
+				console_putchar(ch);
 			else
-				_putchar('.');
+				console_putchar('.');
 		}
-		_putchar('|');
+		console_putchar('|');
 	}
 
 	return 0;
@@ -6,6 +6,31 @@
 
 #include <ucx.h>
 
+/* string and memory functions work a word at a time on 32 and 64 bit
+ * targets (words are size_t). AVR works a byte at a time. */
+#ifndef __AVR__
+#define MEM_WORDS
+typedef size_t __attribute__((__may_alias__)) word_t;
+#define WORD_SIZE		sizeof(word_t)
+#define WORD_MASK		(WORD_SIZE - 1)
+#define mem_words(a, b, n)	((n) >= 2 * WORD_SIZE && !(((size_t)(a) ^ (size_t)(b)) & WORD_MASK))
+
+/* a byte on every byte of a word, and a word with a zero byte. an aligned
+ * word holding the end of a string doesn't cross a word boundary, so it
+ * can be read as a whole. */
+#define WORD_ONES		((word_t)-1 / 0xff)
+#define WORD_HIGHS		(WORD_ONES * 0x80)
+#define has_zero(w)		(((w) - WORD_ONES) & ~(w) & WORD_HIGHS)
+
+/* a word at a byte offset (sh, in bits) from an aligned word a, followed
+ * by b, for copies between buffers with different alignments */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define word_merge(a, b, sh)	(((a) << (sh)) | ((b) >> (8 * WORD_SIZE - (sh))))
+#else
+#define word_merge(a, b, sh)	(((a) >> (sh)) | ((b) << (8 * WORD_SIZE - (sh))))
+#endif
+#endif
+
 char *ucx_strcpy(char *dst, char *src)
 {
 	char *dstSave=dst;
@@ -68,6 +93,25 @@ char *ucx_strncat(char *s1, char *s2, int32_t n)
 
 int32_t ucx_strcmp(char *s1, char *s2)
 {
+#ifdef MEM_WORDS
+	word_t *w1, *w2;
+
+	/* equal words without a terminator are skipped */
+	if (!(((size_t)s1 ^ (size_t)s2) & WORD_MASK)) {
+		for (; (size_t)s1 & WORD_MASK; s1++, s2++)
+			if (*s1 != *s2 || !*s1)
+				return *s1 - *s2;
+		w1 = (word_t *)s1;
+		w2 = (word_t *)s2;
+		while (*w1 == *w2 && !has_zero(*w1)) {
+			w1++;
+			w2++;
+		}
+		s1 = (char *)w1;
+		s2 = (char *)w2;
+	}
+#endif
+
 	while (*s1 == *s2++)
 		if (*s1++ == '\0')
 			return 0;
@@ -84,9 +128,37 @@ int32_t ucx_strncmp(char *s1, char *s2, int32_t n)
 	return (n<0 ? 0 : *s1 - *--s2);
 }
 
+/* Boyer-Moore-Horspool search for long strings: the last character of the
+ * window selects how far the window can move. shifts are limited to 255,
+ * so the table takes 256 bytes of stack. */
 char *ucx_strstr(char *string, char *find)
 {
 	int32_t i;
+#ifdef MEM_WORDS
+	uint8_t skip[256];
+	int32_t m, n;
+	char *p, *end;
+	char last;
+
+	m = ucx_strlen(find);
+	if (m == 1)
+		return ucx_strchr(string, find[0]);
+	n = m > 2 ? ucx_strlen(string) : 0;
+	if (n >= 64) {
+		if (m > n)
+			return 0;
+		ucx_memset(skip, m < 255 ? m : 255, sizeof(skip));
+		for (i = 0; i < m - 1; i++)
+			skip[(uint8_t)find[i]] = m - 1 - i < 255 ? m - 1 - i : 255;
+		last = find[m - 1];
+		end = string + n - m;
+		for (p = string; p <= end; p += skip[(uint8_t)p[m - 1]])
+			if (p[m - 1] == last && !ucx_memcmp(p, find, m - 1))
+				return p;
+
+		return 0;
+	}
+#endif
 
 	while (1) {
 		for (i = 0; string[i] == find[i] && find[i]; ++i);
@@ -99,6 +171,19 @@ char *ucx_strstr(char *string, char *find)
 
 int32_t ucx_strlen(char *s)
 {
+#ifdef MEM_WORDS
+	char *p = s;
+	word_t *w;
+
+	/* words without a terminator are skipped */
+	for (; (size_t)p & WORD_MASK; p++)
+		if (!*p)
+			return p - s;
+	for (w = (word_t *)p; !has_zero(*w); w++);
+	for (p = (char *)w; *p; p++);
+
+	return p - s;
+#else
 	int32_t n;
 
 	n = 0;
@@ -106,10 +191,26 @@ int32_t ucx_strlen(char *s)
 		n++;
 
 	return n;
+#endif
 }
 
 char *ucx_strchr(char *s, int32_t c)
 {
+#ifdef MEM_WORDS
+	word_t *w, v;
+
+	/* words without the character or a terminator are skipped */
+	for (; (size_t)s & WORD_MASK; s++) {
+		if (*s == (char)c)
+			return s;
+		if (!*s)
+			return 0;
+	}
+	v = WORD_ONES * (uint8_t)c;
+	for (w = (word_t *)s; !has_zero(*w) && !has_zero(*w ^ v); w++);
+	s = (char *)w;
+#endif
+
 	while (*s != (char)c)
 		if (!*s++)
 			return 0;
@@ -218,10 +319,45 @@ int32_t ucx_strtol(char *s, char **end, int32_t base)
 	return value;
 }
 
+/* memory functions move (or compare) a word at a time when both pointers
+ * have the same alignment: bytes up to a word boundary, then blocks of 8
+ * words, single words and the bytes left. memory is only accessed on
+ * aligned words. */
+
 void *ucx_memcpy(void *dst, void *src, uint32_t n)
 {
 	char *r1 = dst;
 	char *r2 = src;
+#ifdef MEM_WORDS
+	word_t *w1, *w2, a, b;
+	uint32_t sh;
+
+	if (n >= 2 * WORD_SIZE) {
+		for (; (size_t)r1 & WORD_MASK; n--)
+			*r1++ = *r2++;
+		w1 = (word_t *)r1;
+		sh = ((size_t)r2 & WORD_MASK) * 8;
+		if (!sh) {
+			w2 = (word_t *)r2;
+			for (; n >= 8 * WORD_SIZE; n -= 8 * WORD_SIZE, w1 += 8, w2 += 8) {
+				w1[0] = w2[0]; w1[1] = w2[1]; w1[2] = w2[2]; w1[3] = w2[3];
+				w1[4] = w2[4]; w1[5] = w2[5]; w1[6] = w2[6]; w1[7] = w2[7];
+			}
+			for (; n >= WORD_SIZE; n -= WORD_SIZE)
+				*w1++ = *w2++;
+			r2 = (char *)w2;
+		} else {
+			/* source words are read aligned, and merged */
+			w2 = (word_t *)(r2 - sh / 8);
+			for (a = *w2++; n >= WORD_SIZE; n -= WORD_SIZE, a = b) {
+				b = *w2++;
+				*w1++ = word_merge(a, b, sh);
+			}
+			r2 = (char *)w2 - WORD_SIZE + sh / 8;
+		}
+		r1 = (char *)w1;
+	}
+#endif
 
 	while (n--)
 		*r1++ = *r2++;
@@ -233,16 +369,47 @@ void *ucx_memmove(void *dst, void *src, uint32_t n)
 {
 	char *s = (char *)dst;
 	char *p = (char *)src;
-
-	if (p >= s) {
-		while (n--)
-			*s++ = *p++;
-	} else {
-		s += n;
-		p += n;
-		while (n--)
+#ifdef MEM_WORDS
+	word_t *w1, *w2, a, b;
+	uint32_t sh;
+#endif
+
+	if (p >= s)
+		return ucx_memcpy(dst, src, n);
+
+	/* overlapping, copy backwards */
+	s += n;
+	p += n;
+#ifdef MEM_WORDS
+	if (n >= 2 * WORD_SIZE) {
+		for (; (size_t)s & WORD_MASK; n--)
 			*--s = *--p;
+		w1 = (word_t *)s;
+		sh = ((size_t)p & WORD_MASK) * 8;
+		if (!sh) {
+			w2 = (word_t *)p;
+			for (; n >= 8 * WORD_SIZE; n -= 8 * WORD_SIZE) {
+				w1 -= 8;
+				w2 -= 8;
+				w1[7] = w2[7]; w1[6] = w2[6]; w1[5] = w2[5]; w1[4] = w2[4];
+				w1[3] = w2[3]; w1[2] = w2[2]; w1[1] = w2[1]; w1[0] = w2[0];
+			}
+			for (; n >= WORD_SIZE; n -= WORD_SIZE)
+				*--w1 = *--w2;
+			p = (char *)w2;
+		} else {
+			w2 = (word_t *)(p - sh / 8);
+			for (b = *w2; n >= WORD_SIZE; n -= WORD_SIZE, b = a) {
+				a = *--w2;
+				*--w1 = word_merge(a, b, sh);
+			}
+			p = (char *)w2 + sh / 8;
+		}
+		s = (char *)w1;
 	}
+#endif
+	while (n--)
+		*--s = *--p;
 
 	return dst;
 }
@@ -251,6 +418,25 @@ int32_t ucx_memcmp(void *cs, void *ct, uint32_t n)
 {
 	char *r1 = (char *)cs;
 	char *r2 = (char *)ct;
+#ifdef MEM_WORDS
+	word_t *w1, *w2;
+
+	/* words are compared for equality only, the first different byte
+	 * is found by the byte loop */
+	if (mem_words(r1, r2, n)) {
+		for (; (size_t)r1 & WORD_MASK; n--, r1++, r2++)
+			if (*r1 != *r2)
+				return (*r1 < *r2) ? -1 : 1;
+		w1 = (word_t *)r1;
+		w2 = (word_t *)r2;
+		for (; n >= WORD_SIZE && *w1 == *w2; n -= WORD_SIZE) {
+			w1++;
+			w2++;
+		}
+		r1 = (char *)w1;
+		r2 = (char *)w2;
+	}
+#endif
 
 	while (n && (*r1 == *r2)) {
 		++r1;
@@ -261,9 +447,51 @@ int32_t ucx_memcmp(void *cs, void *ct, uint32_t n)
 	return (n == 0) ? 0 : ((*r1 < *r2) ? -1 : 1);
 }
 
+void *ucx_memchr(void *s, int32_t c, uint32_t n)
+{
+	uint8_t *p = (uint8_t *)s;
+#ifdef MEM_WORDS
+	word_t *w, v;
+
+	if (n >= 2 * WORD_SIZE) {
+		for (; (size_t)p & WORD_MASK; n--, p++)
+			if (*p == (uint8_t)c)
+				return p;
+		v = WORD_ONES * (uint8_t)c;
+		for (w = (word_t *)p; n >= WORD_SIZE && !has_zero(*w ^ v); n -= WORD_SIZE)
+			w++;
+		p = (uint8_t *)w;
+	}
+#endif
+
+	for (; n; n--, p++)
+		if (*p == (uint8_t)c)
+			return p;
+
+	return 0;
+}
+
 void *ucx_memset(void *s, int32_t c, uint32_t n)
 {
 	char *p = (char *)s;
+#ifdef MEM_WORDS
+	word_t *w, v;
+
+	if (n >= 2 * WORD_SIZE) {
+		for (; (size_t)p & WORD_MASK; n--)
+			*p++ = (char)c;
+		/* the byte on every byte of a word */
+		v = (word_t)-1 / 0xff * (uint8_t)c;
+		w = (word_t *)p;
+		for (; n >= 8 * WORD_SIZE; n -= 8 * WORD_SIZE, w += 8) {
+			w[0] = v; w[1] = v; w[2] = v; w[3] = v;
+			w[4] = v; w[5] = v; w[6] = v; w[7] = v;
+		}
+		for (; n >= WORD_SIZE; n -= WORD_SIZE)
+			*w++ = v;
+		p = (char *)w;
+	}
+#endif
 
 	while (n--)
 		*p++ = (char)c;
@@ -292,9 +520,8 @@ void ucx_srand(uint32_t seed)
 
 int32_t ucx_puts(char *str)
 {
-	while (*str)
-		_putchar(*str++);
-	_putchar('\n');
+	ucx_console_write(str, ucx_strlen(str));
+	console_putchar('\n');
 
 	return 0;
 }
@@ -305,7 +532,7 @@ char *ucx_gets(char *s)
 	char *cs;
 
 	cs = s;
-	while ((c = _getchar()) != '\n' && c >= 0)
+	while ((c = console_getchar()) != '\n' && c >= 0)
 		*cs++ = c;
 	if (c < 0 && cs == s)
 		return(NULL);
@@ -319,7 +546,7 @@ char *ucx_getline(char *s)
 	char *cs;
 
 	cs = s;
-	while ((c = _getchar()) != '\n' && c >= 0) {
+	while ((c = console_getchar()) != '\n' && c >= 0) {
 		if (++i == 80) {
 			*cs = '\0';
 			break;
@@ -354,24 +581,45 @@ static int toint(const char **s)
 	return i;
 }
 
-static void printchar(char **str, int32_t c){
-	if (str) {
-		**str = c;
-		++(*str);
-	} else {
-		if (c) _putchar(c);
+/* formatted output goes to a string (sprintf()) or to the console. with
+ * UCX_CONSOLE, console output is gathered on a small buffer, which is
+ * written a chunk at a time (and at the end). */
+#define PRINT_CHUNK	32
+
+struct print_s {
+	char *str;
+#ifdef UCX_CONSOLE
+	char buf[PRINT_CHUNK];
+	uint8_t len;
+#endif
+};
+
+static void printchar(struct print_s *p, int32_t c){
+	if (p->str) {
+		*p->str++ = c;
+		return;
+	}
+#ifdef UCX_CONSOLE
+	if (c)
+		p->buf[p->len++] = c;
+	if (!c || p->len == PRINT_CHUNK) {
+		ucx_console_write(p->buf, p->len);
+		p->len = 0;
 	}
+#else
+	if (c) _putchar(c);
+#endif
 }
 
-static int ucx_vsprintf(char **buf, const char *fmt, va_list args)
+static int ucx_vsprintf(struct print_s *p, const char *fmt, va_list args)
 {
-	char **p, *str;
+	char *str;
 	const char *digits = "0123456789abcdef";
 	char pad, tmp[16];
 	int width, base, sign, i;
 	long num;
 
-	for (p = buf; *fmt; fmt++) {
+	for (; *fmt; fmt++) {
 		if (*fmt != '%') {
 			printchar(p, *fmt);
 			continue;
@@ -445,22 +693,29 @@ static int ucx_vsprintf(char **buf, const char *fmt, va_list args)
 
 int32_t ucx_printf(const char *fmt, ...)
 {
+	struct print_s p;
 	va_list args;
 	int32_t v;
 
+	p.str = 0;
+#ifdef UCX_CONSOLE
+	p.len = 0;
+#endif
 	va_start(args, fmt);
-	v = ucx_vsprintf(0, fmt, args);
+	v = ucx_vsprintf(&p, fmt, args);
 	va_end(args);
 	return v;
 }
 
 int32_t ucx_sprintf(char *out, const char *fmt, ...)
 {
+	struct print_s p;
 	va_list args;
 	int32_t v;
 
+	p.str = out;
 	va_start(args, fmt);
-	v = ucx_vsprintf(&out, fmt, args);
+	v = ucx_vsprintf(&p, fmt, args);
 	va_end(args);
 	return v;
 }
@@ -6,11 +6,14 @@
 
 #include <ucx.h>
 
+/* list heads and nodes */
+static struct pool_s list_pool = POOL_INIT(sizeof(struct list_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
 struct list_s *ucx_list_create(void)
 {
 	struct list_s *lst;
 
-	lst = (struct list_s *)malloc(sizeof(struct list_s));
+	lst = (struct list_s *)ucx_pool_alloc(&list_pool);
 
 	if (lst) {
 		lst->next = 0;
@@ -25,7 +28,7 @@ int32_t ucx_list_destroy(struct list_s *lst)
 	if (lst->next)
 		return -1;
 
-	free(lst);
+	ucx_pool_free(&list_pool, lst);
 
 	return 0;
 }
@@ -34,7 +37,7 @@ int32_t ucx_list_add(struct list_s *lst, void *item)
 {
 	struct list_s *t1, *t2;
 
-	t1 = (struct list_s *)malloc(sizeof(struct list_s));
+	t1 = (struct list_s *)ucx_pool_alloc(&list_pool);
 
 	if (t1) {
 		t1->elem = item;
@@ -100,7 +103,7 @@ int32_t ucx_list_insert(struct list_s *lst, void *item, int32_t pos)
 	struct list_s *t1, *t2;
 	int32_t i = 0;
 
-	t1 = (struct list_s *)malloc(sizeof(struct list_s));
+	t1 = (struct list_s *)ucx_pool_alloc(&list_pool);
 
 	if (t1) {
 		t1->elem = item;
@@ -132,7 +135,7 @@ int32_t ucx_list_remove(struct list_s *lst, int32_t pos)
 	while ((t1 = t1->next)) {
 		if (i++ == pos) {
 			t2->next = t1->next;
-			free(t1);
+			ucx_pool_free(&list_pool, t1);
 
 			return 0;
 		}
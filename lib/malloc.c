@@ -13,6 +13,62 @@
 char _heap[UCX_OS_HEAP_SIZE];
 #endif
 
+/* usage counters, updated by the allocator on every call. free space and
+ * fragmentation are computed by ucx_heap_stats(). */
+struct heap_stats_s heap_counters;
+
+/* charges an allocation to the running task (if the scheduler is running,
+ * allocations from app_main() are not charged), which is returned so it
+ * can be recorded on the block */
+struct tcb_s *heap_account_alloc(uint32_t size)
+{
+	struct tcb_s *owner = 0;
+#ifdef UCX_TASK_STATS
+	extern struct kcb_s *kcb_p;
+#endif
+	
+	heap_counters.allocs++;
+	heap_counters.used += size;
+	if (heap_counters.used > heap_counters.peak)
+		heap_counters.peak = heap_counters.used;
+#ifdef UCX_TASK_STATS
+	if (kcb_p->tcb_p && kcb_p->tcb_p->state == TASK_RUNNING) {
+		owner = kcb_p->tcb_p;
+		owner->stats.heap += size;
+	}
+#endif
+	
+	return owner;
+}
+
+void heap_account_fail(void)
+{
+	heap_counters.failures++;
+}
+
+void heap_account_resize(struct tcb_s *owner, uint32_t old, uint32_t size)
+{
+	heap_counters.used += size - old;
+	if (heap_counters.used > heap_counters.peak)
+		heap_counters.peak = heap_counters.used;
+#ifdef UCX_TASK_STATS
+	if (owner)
+		owner->stats.heap += size - old;
+#endif
+}
+
+void heap_account_free(struct tcb_s *owner, uint32_t size)
+{
+	heap_counters.frees++;
+	heap_counters.used -= size;
+#ifdef UCX_TASK_STATS
+	if (owner)
+		owner->stats.heap -= size;
+#endif
+}
+
+/* first-fit allocator, unless the TLSF allocator (tlsf.c) is selected */
+#ifndef UCX_MALLOC_TLSF
 struct mem_block_s *first_free;
 struct mem_block_s *last_free;
 
@@ -22,6 +78,11 @@ void ucx_free(void *ptr)
 	
 	p = ((struct mem_block_s *)ptr) - 1;
 	p->size &= ~1L;
+#ifdef UCX_TASK_STATS
+	heap_account_free(p->owner, p->size);
+#else
+	heap_account_free(0, p->size);
+#endif
 	last_free = first_free;
 }
 
@@ -29,6 +90,12 @@ void *ucx_malloc(uint32_t size)
 {
 	struct mem_block_s *p, *q, *r, n;
 	
+	/* rounding up would wrap around */
+	if ((int32_t)size < 0) {
+		heap_account_fail();
+		return 0;
+	}
+	
 	size = align4(size);
 	p = last_free;
 	q = p;
@@ -50,8 +117,10 @@ void *ucx_malloc(uint32_t size)
 		}
 	}
 
-	if (p->next == 0)
+	if (p->next == 0) {
+		heap_account_fail();
 		return 0;
+	}
 	
 	last_free = p;
 	r = p->next;
@@ -60,6 +129,11 @@ void *ucx_malloc(uint32_t size)
 	n.next = r;
 	n.size = (p->size & ~1L) - size - sizeof(struct mem_block_s);
 	*p->next = n;
+#ifdef UCX_TASK_STATS
+	p->owner = heap_account_alloc(size);
+#else
+	heap_account_alloc(size);
+#endif
 	
 	return (void *)(p + 1);
 }
@@ -77,21 +151,44 @@ void ucx_heap_init(size_t *zone, uint32_t len)
 	q->size = 0;
 	first_free = (struct mem_block_s *)heap;
 	last_free = (struct mem_block_s *)heap;
+	heap_counters.size = p->size;
 }
 
-void *ucx_calloc(uint32_t size, uint32_t type_size)
+/* free block sizes are only updated when blocks are coalesced, so they
+ * are taken from the block links. adjacent free blocks (not coalesced
+ * yet) are counted as a single one. */
+void ucx_heap_stats(struct heap_stats_s *stats)
 {
-	void *buf;
+	struct mem_block_s *p, *run = 0;
+	uint32_t size;
 	
-	buf = (void *)malloc((size * type_size));
-	if (buf)
-		memset(buf, 0, (size * type_size));
-
-	return (void *)buf;
+	memcpy(stats, &heap_counters, sizeof(struct heap_stats_s));
+	stats->free = 0;
+	stats->largest = 0;
+	stats->fragments = 0;
+	
+	for (p = first_free; p->next; p = p->next) {
+		if (p->size & 1) {
+			run = 0;
+			continue;
+		}
+		if (!run) {
+			run = p;
+			stats->fragments++;
+		}
+		size = (size_t)p->next - (size_t)run - sizeof(struct mem_block_s);
+		if (size > stats->largest)
+			stats->largest = size;
+		stats->free += (size_t)p->next - (size_t)p - (run == p ? sizeof(struct mem_block_s) : 0);
+	}
 }
 
+/* blocks shrink in place, and grow in place over the next blocks if they
+ * are free (coalescing them). otherwise data is moved to a new block. */
 void *ucx_realloc(void *ptr, uint32_t size)
 {
+	struct mem_block_s *p, *q, n;
+	size_t old, avail;
 	void *buf;
 
 	if ((int32_t)size < 0)
@@ -100,12 +197,61 @@ void *ucx_realloc(void *ptr, uint32_t size)
 	if (ptr == NULL)
 		return (void *)malloc(size);
 
+	p = ((struct mem_block_s *)ptr) - 1;
+	old = p->size & ~1L;
+	size = align4(size);
+	
+	/* the following free blocks are merged while they are not enough */
+	q = p->next;
+	avail = old;
+	while (avail < size && !(q->size & 1) && q->next) {
+		q = q->next;
+		avail = (size_t)q - (size_t)ptr;
+	}
+	
+	if (avail >= size) {
+		/* the remainder becomes a free block, if there is room for it */
+		if (avail >= size + sizeof(struct mem_block_s)) {
+			n.next = q;
+			n.size = avail - size - sizeof(struct mem_block_s);
+#ifdef UCX_TASK_STATS
+			n.owner = 0;
+#endif
+			p->next = (struct mem_block_s *)((size_t)ptr + size);
+			*p->next = n;
+		} else {
+			p->next = q;
+			size = avail;
+		}
+		p->size = size | 1;
+		last_free = first_free;
+#ifdef UCX_TASK_STATS
+		heap_account_resize(p->owner, old, size);
+#else
+		heap_account_resize(0, old, size);
+#endif
+		
+		return ptr;
+	}
+
 	buf = (void *)malloc(size);
 	
 	if (buf){
-		memcpy(buf, ptr, size);
+		memcpy(buf, ptr, old);
 		free(ptr);
 	}
 
 	return (void *)buf;
 }
+#endif
+
+void *ucx_calloc(uint32_t size, uint32_t type_size)
+{
+	void *buf;
+	
+	buf = (void *)malloc((size * type_size));
+	if (buf)
+		memset(buf, 0, (size * type_size));
+
+	return (void *)buf;
+}
@@ -0,0 +1,146 @@
+/* file:          pool.c
+ * description:   fixed size block pool implementation
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+/* a pool hands out blocks of a single size from a free list, linked
+ * through the free blocks themselves, so allocation and release are O(1).
+ * blocks come from a static buffer (ucx_pool_init()) or from the heap, in
+ * chunks. a static pool (POOL_INIT()) takes its blocks from the heap on
+ * the first allocation, and only a growable pool takes a new chunk when it
+ * runs out of blocks. chunks are only given back to the heap when the pool
+ * is destroyed, so freed blocks are kept for objects of the same type and
+ * don't fragment the heap. */
+
+static void pool_add(struct pool_s *pool, char *data, uint16_t count)
+{
+	uint16_t i;
+	
+	for (i = count; i > 0; i--) {
+		*(void **)(data + (i - 1) * pool->block_size) = pool->free;
+		pool->free = data + (i - 1) * pool->block_size;
+	}
+	pool->count += count;
+}
+
+/* data must hold POOL_SIZE(block_size, count) bytes */
+int32_t ucx_pool_init(struct pool_s *pool, void *data, uint16_t block_size, uint16_t count)
+{
+	if (block_size < sizeof(void *))
+		block_size = sizeof(void *);
+	
+	pool->free = 0;
+	pool->chunks = 0;
+	pool->block_size = pool_align(block_size);
+	pool->count = 0;
+	pool->used = 0;
+	pool->reserve = 0;
+	pool->grow = 0;
+	pool->created = 0;
+	if (data)
+		pool_add(pool, data, count);
+	
+	return 0;
+}
+
+struct pool_s *ucx_pool_create(uint16_t block_size, uint16_t count)
+{
+	struct pool_s *pool;
+	
+	pool = (struct pool_s *)malloc(sizeof(struct pool_s));
+	
+	if (!pool)
+		return 0;
+	
+	ucx_pool_init(pool, 0, block_size, 0);
+	pool->created = 1;
+	if (count && ucx_pool_grow(pool, count)) {
+		free(pool);
+		return 0;
+	}
+	
+	return pool;
+}
+
+/* only pools from ucx_pool_create() can be destroyed. pools on static
+ * storage (ucx_pool_init(), POOL_INIT()) are kept for good. */
+int32_t ucx_pool_destroy(struct pool_s *pool)
+{
+	void *chunk;
+	
+	if (!pool->created || pool->used)
+		return -1;
+	
+	while (pool->chunks) {
+		chunk = pool->chunks;
+		pool->chunks = *(void **)chunk;
+		free(chunk);
+	}
+	free(pool);
+	
+	return 0;
+}
+
+/* adds blocks to a pool, from the heap */
+int32_t ucx_pool_grow(struct pool_s *pool, uint16_t count)
+{
+	char *chunk;
+	int32_t status;
+	
+	chunk = (char *)malloc(sizeof(void *) + pool->block_size * count);
+	
+	if (!chunk)
+		return -1;
+	
+	status = _di();
+	*(void **)chunk = pool->chunks;
+	pool->chunks = chunk;
+	pool_add(pool, chunk + sizeof(void *), count);
+	_ei(status);
+	
+	return 0;
+}
+
+/* returns a free block, or 0 if the pool is empty (and can't grow) */
+void *ucx_pool_alloc(struct pool_s *pool)
+{
+	void *block;
+	int32_t status;
+	
+	if (!pool->free) {
+		if (!pool->count && pool->reserve)
+			ucx_pool_grow(pool, pool->reserve);
+		else if (pool->grow)
+			ucx_pool_grow(pool, pool->grow);
+	}
+	
+	status = _di();
+	block = pool->free;
+	if (block) {
+		pool->free = *(void **)block;
+		pool->used++;
+	}
+	_ei(status);
+	
+	return block;
+}
+
+void ucx_pool_free(struct pool_s *pool, void *block)
+{
+	int32_t status;
+	
+	status = _di();
+	*(void **)block = pool->free;
+	pool->free = block;
+	pool->used--;
+	_ei(status);
+}
+
+/* free blocks */
+int32_t ucx_pool_count(struct pool_s *pool)
+{
+	return pool->count - pool->used;
+}
@@ -6,6 +6,8 @@
 
 #include <ucx.h>
 
+static struct pool_s queue_pool = POOL_INIT(sizeof(struct queue_s), UCX_POOL_SIZE, UCX_POOL_GROW);
+
 static int32_t ispowerof2(uint32_t x)
 {
 	return x && !(x & (x - 1));
@@ -34,7 +36,7 @@ struct queue_s *ucx_queue_create(int32_t size)
 	if (!ispowerof2(size))
 		size = nextpowerof2(size);
 	
-	q = malloc(sizeof(struct queue_s));
+	q = ucx_pool_alloc(&queue_pool);
 	
 	if (!q)
 		return 0;
@@ -44,7 +46,7 @@ struct queue_s *ucx_queue_create(int32_t size)
 	q->pdata = malloc(q->size * sizeof(void *));
 	
 	if (!q->pdata) {
-		free(q);
+		ucx_pool_free(&queue_pool, q);
 		return 0;
 	}
 	q->head = q->tail = 0;
@@ -57,7 +59,7 @@ int32_t ucx_queue_destroy(struct queue_s *q)
 {
 	if (q->head == q->tail && !q->elem) {
 		free(q->pdata);
-		free(q);
+		ucx_pool_free(&queue_pool, q);
 		
 		return 0;
 	}
@@ -89,7 +91,7 @@ void *ucx_queue_dequeue(struct queue_s *q)
 {
 	int32_t head;
 
-	if (q->head == q->tail)
+	if (!q->elem)
 		return 0;
 
 	head = q->head;
@@ -103,7 +105,7 @@ void *ucx_queue_peek(struct queue_s *q)
 {
 	int32_t head;
 
-	if (q->head == q->tail)
+	if (!q->elem)
 		return 0;
 
 	head = q->head;
@@ -0,0 +1,356 @@
+/* file:          tlsf.c
+ * description:   memory allocator and heap management
+ * 
+ * memory allocator using two level segregated fit (TLSF), selected with
+ * UCX_MALLOC_TLSF. free blocks are kept on segregated lists: a first level
+ * by power of two size class and a second level splitting each class in
+ * TLSF_SL_COUNT ranges. two levels of bitmaps track non empty lists, so a
+ * suitable block is found with a couple of bit scans. blocks are split on
+ * allocation and coalesced with their physical neighbors on release, so
+ * ucx_malloc() and ucx_free() run in bounded (constant) time.
+ * 
+ * date:          10/2026
+ * author:        agent <agent@local>
+ */
+
+#include <ucx.h>
+
+#ifdef UCX_MALLOC_TLSF
+
+/* blocks up to (1 << TLSF_FL_MAX) bytes, larger heaps are truncated */
+#ifndef TLSF_FL_MAX
+#define TLSF_FL_MAX		24
+#endif
+#define TLSF_SL_LOG2		4
+#define TLSF_SL_COUNT		(1 << TLSF_SL_LOG2)
+#define TLSF_ALIGN_LOG2		(sizeof(void *) > 4 ? 3 : 2)
+#define TLSF_ALIGN		(1 << TLSF_ALIGN_LOG2)
+#define TLSF_FL_SHIFT		(TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL		(1 << TLSF_FL_SHIFT)
+#define TLSF_FL_COUNT		(TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+#define TLSF_FREE		1
+
+struct tlsf_block_s {
+	struct tlsf_block_s *prev_phys;		/* previous block in memory */
+	size_t size;				/* payload size. the LSB is set if the block is free */
+#ifdef UCX_TASK_STATS
+	struct tcb_s *owner;			/* task that allocated the block */
+#endif
+	struct tlsf_block_s *next_free;		/* free list links, on the payload of free blocks */
+	struct tlsf_block_s *prev_free;
+};
+
+#define TLSF_HDR		((size_t)&((struct tlsf_block_s *)0)->next_free)
+#define TLSF_MIN		(sizeof(struct tlsf_block_s) - TLSF_HDR)
+
+#define block_size(b)		((b)->size & ~(size_t)(TLSF_ALIGN - 1))
+#define block_next(b)		((struct tlsf_block_s *)((char *)(b) + TLSF_HDR + block_size(b)))
+
+static uint32_t fl_bitmap;
+static uint32_t sl_bitmap[TLSF_FL_COUNT];
+static struct tlsf_block_s *free_list[TLSF_FL_COUNT][TLSF_SL_COUNT];
+static uint32_t free_bytes, free_blocks;
+
+extern struct heap_stats_s heap_counters;
+
+/* most significant bit set (x != 0), with a count leading zeros where the
+ * target has one (as the kernel ready queue bitmap), or a binary search */
+#if defined(__riscv_zbb) || defined(__ARM_FEATURE_CLZ) || defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#define tlsf_fls(x)		(31 - __builtin_clz((uint32_t)(x)))
+#else
+static int32_t tlsf_fls(uint32_t x)
+{
+	int32_t bit = 31;
+	
+	if (!(x & 0xffff0000)) {
+		x <<= 16;
+		bit -= 16;
+	}
+	if (!(x & 0xff000000)) {
+		x <<= 8;
+		bit -= 8;
+	}
+	if (!(x & 0xf0000000)) {
+		x <<= 4;
+		bit -= 4;
+	}
+	if (!(x & 0xc0000000)) {
+		x <<= 2;
+		bit -= 2;
+	}
+	if (!(x & 0x80000000))
+		bit -= 1;
+	
+	return bit;
+}
+#endif
+
+/* least significant bit set (x != 0) */
+static int32_t tlsf_ffs(uint32_t x)
+{
+	return tlsf_fls(x & (~x + 1));
+}
+
+static void tlsf_mapping(size_t size, int32_t *fl, int32_t *sl)
+{
+	int32_t bit;
+	
+	if (size < TLSF_SMALL) {
+		*fl = 0;
+		*sl = size >> TLSF_ALIGN_LOG2;
+	} else {
+		bit = tlsf_fls(size);
+		*sl = (size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+		*fl = bit - TLSF_FL_SHIFT + 1;
+	}
+}
+
+static void tlsf_insert(struct tlsf_block_s *block)
+{
+	int32_t fl, sl;
+	
+	tlsf_mapping(block_size(block), &fl, &sl);
+	block->size |= TLSF_FREE;
+	block->prev_free = 0;
+	block->next_free = free_list[fl][sl];
+	if (block->next_free)
+		block->next_free->prev_free = block;
+	free_list[fl][sl] = block;
+	fl_bitmap |= (uint32_t)1 << fl;
+	sl_bitmap[fl] |= (uint32_t)1 << sl;
+	free_bytes += block_size(block);
+	free_blocks++;
+}
+
+static void tlsf_remove(struct tlsf_block_s *block)
+{
+	int32_t fl, sl;
+	
+	tlsf_mapping(block_size(block), &fl, &sl);
+	block->size &= ~(size_t)TLSF_FREE;
+	if (block->prev_free)
+		block->prev_free->next_free = block->next_free;
+	else
+		free_list[fl][sl] = block->next_free;
+	if (block->next_free)
+		block->next_free->prev_free = block->prev_free;
+	if (!free_list[fl][sl]) {
+		sl_bitmap[fl] &= ~((uint32_t)1 << sl);
+		if (!sl_bitmap[fl])
+			fl_bitmap &= ~((uint32_t)1 << fl);
+	}
+	free_bytes -= block_size(block);
+	free_blocks--;
+}
+
+/* first block on a list of blocks at least size bytes long. the request
+ * is rounded up to the next list, so any block found is large enough. */
+static struct tlsf_block_s *tlsf_search(size_t size)
+{
+	uint32_t map;
+	int32_t fl, sl;
+	
+	if (size >= TLSF_SMALL)
+		size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+	tlsf_mapping(size, &fl, &sl);
+	if (fl >= TLSF_FL_COUNT)
+		return 0;
+	
+	map = sl_bitmap[fl] & (0xffffffff << sl);
+	if (!map) {
+		map = fl + 1 < TLSF_FL_COUNT ? fl_bitmap & (0xffffffff << (fl + 1)) : 0;
+		if (!map)
+			return 0;
+		fl = tlsf_ffs(map);
+		map = sl_bitmap[fl];
+	}
+	sl = tlsf_ffs(map);
+	
+	return free_list[fl][sl];
+}
+
+/* splits a used block, the remainder goes back to the free lists
+ * (coalesced with the next block, if it is free) */
+static void tlsf_split(struct tlsf_block_s *block, size_t size)
+{
+	struct tlsf_block_s *rest, *next;
+	
+	if (block_size(block) < size + TLSF_HDR + TLSF_MIN)
+		return;
+	
+	rest = (struct tlsf_block_s *)((char *)block + TLSF_HDR + size);
+	rest->prev_phys = block;
+	rest->size = block_size(block) - size - TLSF_HDR;
+	block->size = size;
+	next = block_next(rest);
+	if (next->size & TLSF_FREE) {
+		tlsf_remove(next);
+		rest->size += TLSF_HDR + block_size(next);
+	}
+	block_next(rest)->prev_phys = rest;
+	tlsf_insert(rest);
+}
+
+void ucx_free(void *ptr)
+{
+	struct tlsf_block_s *block, *next;
+	int32_t status;
+	
+	if (!ptr)
+		return;
+	
+	block = (struct tlsf_block_s *)((char *)ptr - TLSF_HDR);
+	
+	status = _di();
+#ifdef UCX_TASK_STATS
+	heap_account_free(block->owner, block_size(block));
+#else
+	heap_account_free(0, block_size(block));
+#endif
+	if (block->prev_phys && (block->prev_phys->size & TLSF_FREE)) {
+		tlsf_remove(block->prev_phys);
+		block->prev_phys->size += TLSF_HDR + block_size(block);
+		block = block->prev_phys;
+		block_next(block)->prev_phys = block;
+	}
+	next = block_next(block);
+	if (next->size & TLSF_FREE) {
+		tlsf_remove(next);
+		block->size += TLSF_HDR + block_size(next);
+		block_next(block)->prev_phys = block;
+	}
+	tlsf_insert(block);
+	_ei(status);
+}
+
+void *ucx_malloc(uint32_t size)
+{
+	struct tlsf_block_s *block;
+	int32_t status;
+	
+	/* rounding up would wrap around */
+	if ((int32_t)size < 0) {
+		status = _di();
+		heap_account_fail();
+		_ei(status);
+		return 0;
+	}
+	
+	size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+	if (size < TLSF_MIN)
+		size = TLSF_MIN;
+	
+	status = _di();
+	block = tlsf_search(size);
+	if (!block) {
+		heap_account_fail();
+		_ei(status);
+		return 0;
+	}
+	tlsf_remove(block);
+	tlsf_split(block, size);
+#ifdef UCX_TASK_STATS
+	block->owner = heap_account_alloc(block_size(block));
+#else
+	heap_account_alloc(block_size(block));
+#endif
+	_ei(status);
+	
+	return (char *)block + TLSF_HDR;
+}
+
+/* blocks shrink in place, and grow in place if the next block is free
+ * and large enough. otherwise data is moved to a new block. */
+void *ucx_realloc(void *ptr, uint32_t size)
+{
+	struct tlsf_block_s *block, *next;
+	size_t old;
+	int32_t status;
+	void *buf;
+	
+	if ((int32_t)size < 0)
+		return NULL;
+	
+	if (ptr == NULL)
+		return malloc(size);
+	
+	block = (struct tlsf_block_s *)((char *)ptr - TLSF_HDR);
+	old = block_size(block);
+	size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+	if (size < TLSF_MIN)
+		size = TLSF_MIN;
+	
+	status = _di();
+	next = block_next(block);
+	if (size > old && (next->size & TLSF_FREE) && old + TLSF_HDR + block_size(next) >= size) {
+		tlsf_remove(next);
+		block->size += TLSF_HDR + block_size(next);
+		block_next(block)->prev_phys = block;
+	}
+	if (block_size(block) >= size) {
+		tlsf_split(block, size);
+#ifdef UCX_TASK_STATS
+		heap_account_resize(block->owner, old, block_size(block));
+#else
+		heap_account_resize(0, old, block_size(block));
+#endif
+		_ei(status);
+		
+		return ptr;
+	}
+	_ei(status);
+	
+	buf = malloc(size);
+	if (buf) {
+		memcpy(buf, ptr, old);
+		free(ptr);
+	}
+	
+	return buf;
+}
+
+/* the heap is a single free block, followed by an empty used block */
+void ucx_heap_init(size_t *zone, uint32_t len)
+{
+	struct tlsf_block_s *block, *last;
+	size_t start, size;
+	
+	start = ((size_t)zone + TLSF_ALIGN - 1) & ~(size_t)(TLSF_ALIGN - 1);
+	len -= start - (size_t)zone;
+	size = (len - TLSF_HDR * 2) & ~(size_t)(TLSF_ALIGN - 1);
+	if (size >= (size_t)1 << TLSF_FL_MAX)
+		size = ((size_t)1 << TLSF_FL_MAX) - TLSF_ALIGN;
+	
+	block = (struct tlsf_block_s *)start;
+	block->prev_phys = 0;
+	block->size = size;
+	last = block_next(block);
+	last->prev_phys = block;
+	last->size = 0;
+	tlsf_insert(block);
+	heap_counters.size = size;
+}
+
+/* the largest free block is on the last non empty list */
+void ucx_heap_stats(struct heap_stats_s *stats)
+{
+	struct tlsf_block_s *block;
+	int32_t fl, status;
+	
+	status = _di();
+	memcpy(stats, &heap_counters, sizeof(struct heap_stats_s));
+	stats->free = free_bytes;
+	stats->fragments = free_blocks;
+	stats->largest = 0;
+	if (fl_bitmap) {
+		fl = tlsf_fls(fl_bitmap);
+		block = free_list[fl][tlsf_fls(sl_bitmap[fl])];
+		for (; block; block = block->next_free)
+			if (block_size(block) > stats->largest)
+				stats->largest = block_size(block);
+	}
+	_ei(status);
+}
+
+#endif